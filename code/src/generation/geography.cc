@@ -2,6 +2,12 @@
 #include "tile.h"
 #include <assert.h>
 #include "position.h"
+#include "navGrid.h"
+#include "landmarks.h"
+#include "../simulation/roadGraph.h"
+#include "../simulation/routeCache.h"
+#include "../simulation/flowField.h"
+#include <algorithm>
 #define DEBUG false
 
 
@@ -12,6 +18,10 @@ Geography::Geography(std::string seed) {
       map[i][j] = NULL;
     }
     }
+  navGrid = NULL;
+  roadGraph = NULL;
+  routeCache = new RouteCache();
+  landmarks = NULL;
   return;
 }
 
@@ -21,6 +31,10 @@ Geography::Geography(){
       map[i][j] = NULL;
     }
     }
+  navGrid = NULL;
+  roadGraph = NULL;
+  routeCache = new RouteCache();
+  landmarks = NULL;
   return;
 }
 
@@ -31,6 +45,10 @@ Geography::Geography(const Geography& mapToBeCopied){
 	map[i][j] = new Tile(*mapToBeCopied.map[i][j]);
     }
   }
+  navGrid = NULL;
+  roadGraph = NULL;
+  routeCache = new RouteCache();
+  landmarks = NULL;
 }
 
 Geography::~Geography() {
@@ -40,6 +58,10 @@ Geography::~Geography() {
       delete map[i][j];
     }
     }
+  delete landmarks;
+  delete routeCache;
+  delete roadGraph;
+  delete navGrid;
 
   return;
 }
@@ -77,6 +99,86 @@ Tile* Geography::getTile(std::pair<int,int> p){
   return getTile(p.first,p.second);
 };
 
+const NavGrid& Geography::getNavGrid(){
+  //les tiles ne sont lues qu'une fois, les blocages passent ensuite par setBlocked
+  std::call_once(navGridBuilt, [this]() {
+      navGrid = new NavGrid(*this);
+    });
+  return *navGrid;
+}
+
+const RoadGraph& Geography::getRoadGraph(){
+  const NavGrid& grid = getNavGrid();
+  std::call_once(roadGraphBuilt, [this,&grid]() {
+      roadGraph = new RoadGraph(*this,grid);
+    });
+  return *roadGraph;
+}
+
+RouteCache& Geography::getRouteCache(){
+  return *routeCache;
+}
+
+void Geography::invalidateRoutes(){
+  routeCache->clear();
+  return;
+}
+
+int Geography::setBlocked(const std::vector<std::pair<int,int>>& tiles, bool blocked){
+  getNavGrid();
+  std::vector<int> changed;
+  for (const std::pair<int,int>& t : tiles) {
+    int id = navGrid->getId(t.first,t.second);
+    if (isInTheMap(t.first,t.second) && navGrid->setBlocked(id,blocked)) {
+      changed.push_back(id);
+    }
+  }
+  if (!changed.empty()) {
+    getRoadGraph();
+    roadGraph->refresh(*navGrid);
+    invalidateRoutes();
+    for (std::shared_ptr<FlowField>& field : flowFields) {
+      field->refresh(*navGrid,changed);
+    }
+  }
+  return (int) changed.size();
+}
+
+std::shared_ptr<const FlowField> Geography::getFlowField(std::vector<int> goals){
+  std::sort(goals.begin(),goals.end());
+  goals.erase(std::unique(goals.begin(),goals.end()),goals.end());
+  for (auto it = flowFields.begin(); it != flowFields.end(); it++) {
+    if ((*it)->getGoals() == goals) {
+      //il redevient le plus récent
+      flowFields.splice(flowFields.begin(),flowFields,it);
+      return flowFields.front();
+    }
+  }
+  flowFields.push_front(std::make_shared<FlowField>(getNavGrid(),goals));
+  //on ne jette que les champs que plus personne ne suit
+  auto it = flowFields.end();
+  while ((int) flowFields.size() > MAX_FLOW_FIELDS && it != flowFields.begin()) {
+    it--;
+    if (it->use_count() == 1) {
+      it = flowFields.erase(it);
+    }
+  }
+  return flowFields.front();
+}
+
+void Geography::buildLandmarks(int count){
+  delete landmarks;
+  landmarks = NULL;
+  if (count > 0) {
+    landmarks = new Landmarks(getNavGrid(),count);
+  }
+  return;
+}
+
+const Landmarks* Geography::getLandmarks(){
+  return landmarks;
+}
+
 Tile& Geography::getTileRef(int i,int j){
   if (!(i>=0 && i<MAP_WIDTH && j>=0 && j<MAP_HEIGHT)) {
     printf("getTileRef error : i=%d, j=%d\n",i,j);
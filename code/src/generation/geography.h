@@ -2,14 +2,23 @@
 #define GEOGRAPHY
 
 #include <string>
+#include <vector>
 #include "tile.h"
 #include <SFML/Graphics.hpp>
 #include <iostream>
 #include <cerrno>
+#include <mutex>
+#include <list>
+#include <memory>
 
 class Position;
 
 class Tile;
+class NavGrid;
+class RoadGraph;
+class RouteCache;
+class Landmarks;
+class FlowField;
 
 /**
  * @brief this class creates the map of the game
@@ -32,6 +41,29 @@ class Geography {
    * The map, which is a matrix of tiles
    */
   Tile* map[MAP_HEIGHT][MAP_WIDTH];
+  /**
+   * The moves allowed on the map, built at the first getNavGrid
+   */
+  NavGrid* navGrid;
+  std::once_flag navGridBuilt;
+  /**
+   * The intersections and roads of the map, built at the first getRoadGraph
+   */
+  RoadGraph* roadGraph;
+  std::once_flag roadGraphBuilt;
+  /**
+   * The last routes computed on the map
+   */
+  RouteCache* routeCache;
+  /**
+   * The landmarks of the map, NULL until buildLandmarks
+   */
+  Landmarks* landmarks;
+  /**
+   * The last flow fields asked for, the most recent first
+   */
+  std::list<std::shared_ptr<FlowField>> flowFields;
+  static const int MAX_FLOW_FIELDS = 8;
   /**
    * @brief transform the seed in int to be used in the generation algorithm
    * @param seed : a string given a player, to create a random map
@@ -97,6 +129,59 @@ class Geography {
    * @return a ref of the tile
    */
   Tile* getTile(std::pair<int,int>);
+  /**
+   * @brief gives the moves allowed on the map, for the pathfinding
+   * the grid is built at the first call, which must happen once the map is
+   * generated ; it is safe to call from several threads
+   * @return the grid of the map
+   */
+  const NavGrid& getNavGrid();
+  /**
+   * @brief gives the road network of the map, for the pathfinding over long
+   * distances ; like getNavGrid, it is built at the first call
+   * @return the graph of the map
+   */
+  const RoadGraph& getRoadGraph();
+  /**
+   * @brief gives the routes already computed on the map, see Trajectory::findPath
+   * @return the cache of the map
+   */
+  RouteCache& getRouteCache();
+  /**
+   * @brief to be called when tiles have become walkable or not : forgets
+   * the routes computed before
+   */
+  void invalidateRoutes();
+  /**
+   * @brief blocks tiles, or unblocks them : updates the grid (see
+   * NavGrid::setBlocked) and the road network, and forgets the routes
+   * computed before ; to be called from the simulation thread
+   * @param tiles : the coordinates of the tiles, those out of the map are ignored
+   * @param blocked : true to block them, false to unblock them
+   * @return the number of tiles which changed
+   */
+  int setBlocked(const std::vector<std::pair<int,int>>& tiles, bool blocked);
+  /**
+   * @brief computes the distances from count landmarks to every tile, which
+   * speed the tile A* up (see Landmarks) ; to be called once the map is
+   * generated, before any route is searched
+   * @param count : the number of landmarks, 0 to do without
+   */
+  void buildLandmarks(int count);
+  /**
+   * @brief gives the landmarks of the map
+   * @return the landmarks, or NULL if buildLandmarks was not called
+   */
+  const Landmarks* getLandmarks();
+  /**
+   * @brief gives the flow field towards a set of tiles, computed at the first
+   * call for this set and then kept up to date by setBlocked ; the fields
+   * no longer followed by anybody are dropped when there are too many.
+   * To be called from the simulation thread
+   * @param goals : the ids of the goal tiles (see NavGrid::getId), in any order
+   * @return the field
+   */
+  std::shared_ptr<const FlowField> getFlowField(std::vector<int> goals);
     /**
      * @brief gives a tile of the map caracterized by these coordinates
      * @param first : abscissa of the tile second : ordinate of the tile
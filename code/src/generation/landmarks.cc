@@ -0,0 +1,85 @@
+#include "landmarks.h"
+#include "navGrid.h"
+#include <cstddef>
+
+
+/**
+ * @brief breadth first search from a tile, every move costing 1
+ */
+static void distancesFrom(const NavGrid& grid,int from,unsigned short* d,std::vector<int>& queue) {
+  int size = grid.getSize();
+  for (int id = 0; id < size; id++) {
+    d[id] = Landmarks::UNKNOWN;
+  }
+  queue.clear();
+  queue.push_back(from);
+  d[from] = 0;
+  int neighbours[4];
+  for (size_t q = 0; q < queue.size(); q++) {
+    int x = queue[q];
+    //au-delà, on ne sait plus rien dire
+    if (d[x] + 1 >= Landmarks::UNKNOWN) {
+      break;
+    }
+    int n = grid.getNeighbours(x, neighbours);
+    for (int k = 0; k < n; k++) {
+      int y = neighbours[k];
+      if (d[y] == Landmarks::UNKNOWN) {
+        d[y] = d[x] + 1;
+        queue.push_back(y);
+      }
+    }
+  }
+  return;
+}
+
+
+Landmarks::Landmarks(const NavGrid& grid,int wanted) {
+  size = grid.getSize();
+  symmetric = grid.isSymmetric();
+  count = 0;
+  if (wanted <= 0) {
+    return;
+  }
+  int origin = 0;
+  while (origin < size && grid.getMoves(origin) == 0) {
+    origin++;
+  }
+  if (origin == size) {
+    return;
+  }
+
+  //le premier repère est le plus loin d'une tile quelconque, chaque suivant
+  //le plus loin des précédents
+  std::vector<int> queue;
+  std::vector<unsigned short> d(size);
+  distancesFrom(grid, origin, &d[0], queue);
+  std::vector<unsigned short> nearest(d);
+  distances.resize((size_t) wanted*size);
+  while (count < wanted) {
+    int next = -1;
+    for (int id = 0; id < size; id++) {
+      if (nearest[id] != UNKNOWN && (next == -1 || nearest[id] > nearest[next])) {
+        next = id;
+      }
+    }
+    if (next == -1 || (count > 0 && nearest[next] == 0)) {
+      break;
+    }
+    unsigned short* row = &distances[(size_t) count*size];
+    distancesFrom(grid, next, row, queue);
+    landmarks.push_back(next);
+    count++;
+    if (count == 1) {
+      nearest.assign(row, row+size);
+    } else {
+      for (int id = 0; id < size; id++) {
+        if (row[id] < nearest[id]) {
+          nearest[id] = row[id];
+        }
+      }
+    }
+  }
+  distances.resize((size_t) count*size);
+  return;
+}
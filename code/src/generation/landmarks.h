@@ -0,0 +1,81 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+
+#include <vector>
+
+class NavGrid;
+
+/**
+ * @brief The Landmarks class
+ * the distances from a few tiles of a map, the landmarks, to every tile,
+ * which give the A* of the Pathfinder a lower bound of the distance between
+ * two tiles far better than the straight line on a city of long blocks
+ * (the ALT heuristic) :
+ *   d(v,t) >= d(L,t) - d(L,v)
+ * and, if the grid is symmetric, d(v,t) >= d(L,v) - d(L,t).
+ * The landmarks are spread over the map, each one as far as possible from
+ * the previous ones. The tables are computed once per map, see
+ * Geography::buildLandmarks, then only read.
+ */
+class Landmarks {
+ public:
+  /**
+   * @brief Landmarks
+   * picks count landmarks on the grid and computes their distances
+   */
+  Landmarks(const NavGrid& grid,int count);
+
+  int getCount() const {
+    return count;
+  }
+
+  /**
+   * @brief getLandmark
+   * @return the tile id of the k-th landmark
+   */
+  int getLandmark(int k) const {
+    return landmarks[k];
+  }
+
+  /**
+   * @brief getDistance
+   * @return the distance from the k-th landmark to the tile id, UNKNOWN if
+   * the tile cannot be reached or is too far
+   */
+  unsigned short getDistance(int k,int id) const {
+    return distances[k*size+id];
+  }
+
+  /**
+   * @brief lowerBound
+   * @return a lower bound of the distance from the tile v to the tile t
+   */
+  float lowerBound(int v,int t) const {
+    float bound = 0;
+    for (int k = 0; k < count; k++) {
+      const unsigned short* d = &distances[k*size];
+      if (d[v] == UNKNOWN || d[t] == UNKNOWN) {
+        continue;
+      }
+      float diff = (float) d[t] - (float) d[v];
+      if (symmetric && diff < 0) {
+        diff = -diff;
+      }
+      if (diff > bound) {
+        bound = diff;
+      }
+    }
+    return bound;
+  }
+
+  static const unsigned short UNKNOWN = 0xFFFF;
+
+ private:
+  int count;
+  int size;
+  bool symmetric;
+  std::vector<int> landmarks;
+  std::vector<unsigned short> distances; // distances[k*size+id]
+};
+
+#endif // LANDMARKS_H
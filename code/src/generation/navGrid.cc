@@ -0,0 +1,97 @@
+#include "navGrid.h"
+#include "geography.h"
+#include "tile.h"
+#include <algorithm>
+
+
+NavGrid::NavGrid(Geography& map) {
+  width = map.getMapWidth();
+  height = map.getMapHeight();
+  initial.assign(width*height, 0);
+  blocked.assign(width*height, 0);
+  for (int i = 0; i < width; i++) {
+    for (int j = 0; j < height; j++) {
+      Tile* t = map.getTile(i,j);
+      unsigned char m = 0;
+      //on ne sort jamais de la carte, même si la tile le prétend
+      if (t->getGod() && j > 0) m |= DOWN;
+      if (t->getGol() && i > 0) m |= LEFT;
+      if (t->getGor() && i < width-1) m |= RIGHT;
+      if (t->getGou() && j < height-1) m |= UP;
+      initial[i*height+j] = m;
+    }
+  }
+  std::vector<std::atomic<unsigned char>> m(width*height);
+  moves.swap(m);
+  for (int id = 0; id < width*height; id++) {
+    moves[id].store(initial[id], std::memory_order_relaxed);
+  }
+  //bloquer une tile retire les mouvements dans les deux sens : la symétrie
+  //ne dépend que des tiles
+  symmetric = true;
+  for (int id = 0; id < width*height && symmetric; id++) {
+    unsigned char m = initial[id];
+    symmetric = (!(m & DOWN) || (initial[id-1] & UP))
+      && (!(m & UP) || (initial[id+1] & DOWN))
+      && (!(m & LEFT) || (initial[id-height] & RIGHT))
+      && (!(m & RIGHT) || (initial[id+height] & LEFT));
+  }
+  return;
+}
+
+
+void NavGrid::refresh(int id) {
+  unsigned char m = 0;
+  if (!blocked[id]) {
+    m = initial[id];
+    if ((m & DOWN) && blocked[id-1]) m &= ~DOWN;
+    if ((m & LEFT) && blocked[id-height]) m &= ~LEFT;
+    if ((m & RIGHT) && blocked[id+height]) m &= ~RIGHT;
+    if ((m & UP) && blocked[id+1]) m &= ~UP;
+  }
+  moves[id].store(m, std::memory_order_relaxed);
+  return;
+}
+
+
+bool NavGrid::setBlocked(int id,bool block) {
+  if (isBlocked(id) == block) {
+    return false;
+  }
+  blocked[id] = block;
+  refresh(id);
+  int i = getAbs(id), j = getOrd(id);
+  if (j > 0) refresh(id-1);
+  if (i > 0) refresh(id-height);
+  if (i < width-1) refresh(id+height);
+  if (j < height-1) refresh(id+1);
+  return true;
+}
+
+
+bool NavGrid::isClear(int a,int b) const {
+  int i0 = std::min(getAbs(a),getAbs(b)), i1 = std::max(getAbs(a),getAbs(b));
+  int j0 = std::min(getOrd(a),getOrd(b)), j1 = std::max(getOrd(a),getOrd(b));
+  for (int i = i0; i <= i1; i++) {
+    for (int j = j0; j <= j1; j++) {
+      if (blocked[getId(i,j)]) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+
+bool NavGrid::inSight(int a,int b) const {
+  int i0 = std::min(getAbs(a),getAbs(b)), i1 = std::max(getAbs(a),getAbs(b));
+  int j0 = std::min(getOrd(a),getOrd(b)), j1 = std::max(getOrd(a),getOrd(b));
+  for (int i = i0; i <= i1; i++) {
+    for (int j = j0; j <= j1; j++) {
+      if (getMoves(getId(i,j)) == 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,153 @@
+#ifndef NAV_GRID_H
+#define NAV_GRID_H
+
+#include <vector>
+#include <atomic>
+
+class Geography;
+
+/**
+ * @brief The NavGrid class
+ * the moves allowed from every tile of a map, one byte per tile, read once
+ * from the gou/god/gol/gor flags of the tiles.
+ * Tile (i,j) has the id i*height+j, as in the AnxietyField.
+ * Tiles can be blocked (rubble, fire...) and unblocked afterwards by the
+ * simulation thread, see setBlocked : the grid is then always the one read
+ * from the tiles, minus the moves into and out of the blocked tiles. The
+ * moves are atomic bytes, so the searches running in other threads meanwhile
+ * stay safe ; they see some of the changes only, and their routes must be
+ * checked against the grid, see Simulation::routeNPC.
+ */
+class NavGrid {
+ public:
+  /* bits of getMoves */
+  static const unsigned char DOWN = 1;  // vers (i,j-1), god
+  static const unsigned char LEFT = 2;  // vers (i-1,j), gol
+  static const unsigned char RIGHT = 4; // vers (i+1,j), gor
+  static const unsigned char UP = 8;    // vers (i,j+1), gou
+
+  /**
+   * @brief NavGrid
+   * reads the moves of every tile of the map
+   */
+  NavGrid(Geography& map);
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+  /**
+   * @brief getSize
+   * @return the number of tiles, ie the first invalid id
+   */
+  int getSize() const {
+    return width*height;
+  }
+
+  int getId(int i,int j) const {
+    return i*height+j;
+  }
+
+  int getAbs(int id) const {
+    return id / height;
+  }
+
+  int getOrd(int id) const {
+    return id % height;
+  }
+
+  unsigned char getMoves(int id) const {
+    return moves[id].load(std::memory_order_relaxed);
+  }
+
+  bool isBlocked(int id) const {
+    return blocked[id] != 0;
+  }
+
+  /**
+   * @brief setBlocked
+   * forbids or allows again every move into and out of a tile ; to be
+   * called from the simulation thread only
+   * @return true iff the tile changed
+   */
+  bool setBlocked(int id,bool block);
+
+  /**
+   * @brief isClear
+   * @return true iff no tile of the rectangle whose corners are the tiles a
+   * and b is blocked : a straight line from anywhere in a to anywhere in b,
+   * a leg of a Trajectory, stays in this rectangle
+   */
+  bool isClear(int a,int b) const;
+
+  /**
+   * @brief inSight
+   * @return true iff every tile of the rectangle whose corners are the tiles
+   * a and b is walkable, so that one can go straight from a to b
+   */
+  bool inSight(int a,int b) const;
+
+  /**
+   * @brief isSymmetric
+   * @return true iff every move can be made backwards, ie the distance from
+   * a tile to another is the distance back
+   */
+  bool isSymmetric() const {
+    return symmetric;
+  }
+
+  /**
+   * @brief getNeighbours
+   * writes the ids of the tiles reachable in one move from the tile id, in the
+   * order of Tile::getNeighbourTiles
+   * @param out : room for 4 ids
+   * @return the number of ids written
+   */
+  int getNeighbours(int id,int out[4]) const {
+    unsigned char m = moves[id].load(std::memory_order_relaxed);
+    int n = 0;
+    if (m & UP) out[n++] = id+1;
+    if (m & RIGHT) out[n++] = id+height;
+    if (m & LEFT) out[n++] = id-height;
+    if (m & DOWN) out[n++] = id-1;
+    return n;
+  }
+
+  /**
+   * @brief isAligned
+   * @return true iff the tiles a, b and c are on the same row or column, b
+   * strictly between a and c, so that b can be skipped when going from a to c
+   */
+  bool isAligned(int a,int b,int c) const {
+    int ai = getAbs(a), bi = getAbs(b), ci = getAbs(c);
+    int aj = getOrd(a), bj = getOrd(b), cj = getOrd(c);
+    if (ai == bi && bi == ci) {
+      return (aj < bj && bj < cj) || (aj > bj && bj > cj);
+    }
+    if (aj == bj && bj == cj) {
+      return (ai < bi && bi < ci) || (ai > bi && bi > ci);
+    }
+    return false;
+  }
+
+ private:
+  int width;
+  int height;
+  std::vector<unsigned char> initial;  // moves read from the tiles
+  std::vector<std::atomic<unsigned char>> moves;
+  std::vector<unsigned char> blocked;
+  bool symmetric;
+
+  /**
+   * @brief refresh
+   * recomputes the moves of a tile from its initial ones and the blocked
+   * tiles around
+   */
+  void refresh(int id);
+};
+
+#endif // NAV_GRID_H
@@ -4,7 +4,6 @@
 #include "tile.h"
 #include "../simulation/position.h"
 #include "../simulation/npc.h"
-#include "../simulation/tilewrapper.h"
 #include "debug.h"
 #include "../scenario/Stuff.h"
 #include "../scenario/StuffList.h"
@@ -82,7 +81,6 @@ Tile::Tile(int abs, int ord, TileType typeO, bool destructibleO, float anxietyO,
       // this->sprite.setTextureRect(sf::IntRect(this->stp->X1,this->stp->Y1,this->stp->X2,this->stp->Y2));
     }  
   this->destructionLevel = 0.;
-  wrapper = NULL;
   this->filePictures = filePicturesO;
   alpha = false;
   fog = 0;
@@ -102,7 +100,6 @@ Tile::Tile() :
   coord(0,0),
   coordBorough(Coordinates()),
   picture(Coordinates()) {
-  wrapper = nullptr;
   alpha = false;
   fog = 0;
   buildfog = false;
@@ -128,7 +125,6 @@ Tile::Tile(const Tile& t) :
 
   stp = t.stp; 
   if (stp) { sprite.setTexture(stp->texture); }
-  wrapper = t.wrapper;
 
   destructionLevel = t.destructionLevel;
   filePictures = t.filePictures;
@@ -159,8 +155,7 @@ Tile& Tile::operator=(const Tile& t){
     
     stp = t.stp; 
     if (stp) { sprite.setTexture(stp->texture); }
-    wrapper = t.wrapper;
-
+  
     destructionLevel = t.destructionLevel;
     filePictures = t.filePictures;
     alpha = t.alpha;
@@ -183,8 +178,6 @@ float Tile::getAnxiety(){
 
 
 void Tile::setAnxiety(float f){
-  DBG << "nobody : anxiety : " << f << "in " ;
-  nobodyTile();
   this->anxiety=f;
   return;
 }
@@ -321,26 +314,6 @@ bool Tile::equals(Tile& t) {
 }
 
 
-TileWrapper* Tile::getWrapper() {
-  return wrapper;
-}
-
-
-void Tile::setWrapper(TileWrapper* t) {
-  wrapper = t;
-  return;
-}
-
-
-void Tile::resetWrapper() {
-  if (wrapper) {
-    delete wrapper;
-    wrapper = NULL;
-  }
-  return;
-}
-
-
 bool Tile::getGod() {
   return god;
 }
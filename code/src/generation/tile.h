@@ -15,7 +15,6 @@ enum TileType {ROADH, ROADV, INTER, BANK, HOUSE, BLANK}; // énumération des ty
 
 
 class NPC;
-class TileWrapper;
 class Geography;
 class Clickable;
 
@@ -169,7 +168,6 @@ class Tile {
    */
   // sf::Sprite& getTSprite(TileType type);
 
-  TileWrapper* wrapper;
   bool alpha;
   int fog;
   bool buildfog;
@@ -287,24 +285,6 @@ class Tile {
    */
   bool equals(Tile& t);
 
-  /**
-   * @brief getWrapper
-   * @return a pointer to the Tile's wrapper
-   */
-  TileWrapper* getWrapper();
-
-  /**
-   * @brief setWrapper
-   * changes the Tile's wrapper
-   * @param t: a pointer to the new wrapper
-   */
-  void setWrapper(TileWrapper* t);
-
-  /**
-   * @brief resetWrapper
-   * if the wrapper* is not null, deletes it and sets it to null
-   */
-  void resetWrapper();
     
   /**
    *@brief Sets the texture of the tile
@@ -177,7 +177,7 @@ void HudTerro::event(sf::RenderWindow* window, sf::Event event, GraphicContextIs
 			if (event.mouseButton.button == sf::Mouse::Left) {
         sf::Vector2i clicPosition = sf::Mouse::getPosition(*window); 
         Position mapPosition = context.screenToMap(clicPosition.x,clicPosition.y);
-        std::list<NPC*> NPCList = mapPosition.getNPCList(*(simulation.getMap()));       
+        std::list<NPC*> NPCList = mapPosition.getNPCList(simulation);       
         // This list contains all the NPCs for which the click is in the hitbox
         if (!NPCList.empty()) {
           stack->sendNpc((*(NPCList.front())).getUuid());
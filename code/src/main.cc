@@ -40,6 +40,9 @@ bool TERRO = true;
 bool AUTOPLAY = false;
 bool CLIENT = false;
 std::string SEED = "424242";
+int TICK_RATE = 30;
+std::string PROFILE_FILE = "";
+int LANDMARKS = 8;
 #define DEBUG true
 #include "debug.h"
 
@@ -55,6 +58,7 @@ void clientLoop(int id, int nbPlayers, bool isFullScreen,
     sf::RenderWindow* window) {
 
   Geography geo = Generation1(seed);
+  geo.buildLandmarks(LANDMARKS);
   DBG<<(geo.getWalkableTile()->getCoord().getAbs());
   LocalState loc = LocalState(&geo, nbPlayers, 1);
   HScenario scenar = HScenario(loc);
@@ -71,12 +75,14 @@ void clientLoop(int id, int nbPlayers, bool isFullScreen,
   }
 
   sf::Clock clock;
-  sf::Time dt = sf::Time::Zero;
+  TickScheduler& scheduler = loc.getScheduler();
+  scheduler.setTickRate(TICK_RATE);
   HudMayor hudMayor = HudMayor(window,loc); //One needs to be removed
   HudTerro hudTerro = HudTerro(window, loc, graContIso);
   //hudTerro.init();
   while ((*window).isOpen()) {
-    dt = clock.restart();
+    //la simulation avance par ticks fixes, l'affichage à chaque frame
+    int ticks = scheduler.advance(clock.restart());
     if (TERRO) {
       hudTerro.init();
     }
@@ -114,7 +120,9 @@ void clientLoop(int id, int nbPlayers, bool isFullScreen,
       else {hudMayor.event(window,event,&tilemap,&loc);}
     }
 
-    loc.run(dt);
+    for (int i = 0; i < ticks; i++) {
+      loc.run(scheduler.getTickLength());
+    }
     window->clear();
     if (TERRO) {
       graContIso.run(window);
@@ -134,6 +142,7 @@ void serverLoop(int id, int nbPlayers, Server* serverPtr, std::string seed,
     sf::RenderWindow* window) {
 
   Geography geo = Generation1(seed);
+  geo.buildLandmarks(LANDMARKS);
   GlobalState glob = GlobalState(&geo, nbPlayers, id);
   Tile* firstTile = geo.getWalkableTile();
   glob.addPlayer(Player(1, (firstTile->getCoord()).getAbs(),
@@ -151,12 +160,15 @@ void serverLoop(int id, int nbPlayers, Server* serverPtr, std::string seed,
   dummy::createNPCs(500, glob, geo, npcGen);
 
 
-  sf::Clock clock;
-  sf::Time dt = sf::Time::Zero;
+  //on dort jusqu'au prochain tick au lieu de tourner à vide
+  TickScheduler& scheduler = glob.getScheduler();
+  scheduler.setTickRate(TICK_RATE);
+  glob.getProfiler().setDumpFile(PROFILE_FILE);
   while (window->isOpen()) {
-    dt = clock.restart();
-    //        sf::Event event;
-    glob.run(dt);
+    int ticks = scheduler.waitNextTick();
+    for (int i = 0; i < ticks; i++) {
+      glob.run(scheduler.getTickLength());
+    }
   }
 
   return;
@@ -269,8 +281,7 @@ int main(int argc, char ** argv) {
   textures::initialize();
 
   if (argc > 2 && (std::string) argv[1] == "test") {
-    test::run(argv[2]);
-    exit(0);
+    exit(test::run(argv[2], std::vector<std::string>(argv + 3, argv + argc)));
   }
 
   std::string cur;
@@ -281,6 +292,9 @@ int main(int argc, char ** argv) {
     if (cur == "terro") TERRO = true; // Show terro view (default: yes)
     if (cur == "client") CLIENT = true; // Client only (default:  no)
     if (cur == "seed" && argc > i+1) SEED = (std::string)argv[++i]; // Seed setting (default: "424242"). Consumes next argument.
+    if (cur == "tickrate" && argc > i+1) TICK_RATE = atoi(argv[++i]); // Simulation ticks per second (default: 30). Consumes next argument.
+    if (cur == "profile" && argc > i+1) PROFILE_FILE = (std::string)argv[++i]; // File the server's tick timings are appended to (default: none). Consumes next argument.
+    if (cur == "landmarks" && argc > i+1) LANDMARKS = atoi(argv[++i]); // Landmarks precomputed for the pathfinding, 0 for none (default: 8). Consumes next argument.
   }
 
   int sizeFenetre[3], b;
@@ -5,6 +5,7 @@
 #include <boost/archive/text_oarchive.hpp>
 #include "ActionBoost.h"
 #include "abstractMessage.h"
+#include "wireCodec.h"
 #include "netEvent.h"
 #include "test/test_net.h"
 #include "gameUpdate.h"
@@ -17,11 +18,14 @@
 #include "interfaceinit/chat_event.h"
 #include "simulation/npc.h"
 #include "npcUpdate.h"
+#include "snapshotAck.h"
 /*
  * @author mheinric
  */
 
 //Registers the classes used for serialization
+//The text archives are not used on the network any more, but still
+//serve for debugging and in the benchmark of the wire format (test_net)
 BOOST_CLASS_EXPORT(AbstractMessage)
 BOOST_CLASS_EXPORT(NetEvent)
 BOOST_CLASS_EXPORT(test::TestA)
@@ -40,35 +44,101 @@ BOOST_CLASS_EXPORT(AddCops)
 BOOST_CLASS_EXPORT(ChatEvent)
 BOOST_CLASS_EXPORT(NPC)
 BOOST_CLASS_EXPORT(NpcUpdate)
+BOOST_CLASS_EXPORT(SnapshotAck)
+
+//Type ids on the network : never change nor reuse one
+WIRE_TYPE(NetEvent, 1)
+WIRE_TYPE(test::TestA, 2)
+WIRE_TYPE(test::TestB, 3)
+WIRE_TYPE(GameUpdate, 4)
+WIRE_TYPE(Action, 5)
+WIRE_TYPE(AddCop, 6)
+WIRE_TYPE(AddCam, 7)
+WIRE_TYPE(NewMouseMovNetwork, 8)
+WIRE_TYPE(NewMovNetwork, 9)
+WIRE_TYPE(ScenarioAction, 10)
+WIRE_TYPE(ChangeDirection, 11)
+WIRE_TYPE(ChangeDestination, 12)
+WIRE_TYPE(AddCams, 13)
+WIRE_TYPE(AddCops, 14)
+WIRE_TYPE(ChatEvent, 15)
+WIRE_TYPE(NPC, 16)
+WIRE_TYPE(NpcUpdate, 17)
+WIRE_TYPE(SnapshotAck, 18)
+WIRE_TYPE(A_Pick, 19)
+WIRE_TYPE(CoA_Pick, 20)
+WIRE_TYPE(A_Kick, 21)
+WIRE_TYPE(CoA_Kick, 22)
+WIRE_TYPE(A_Shoot, 23)
+WIRE_TYPE(CoA_Shoot, 24)
+WIRE_TYPE(A_Reload, 25)
+WIRE_TYPE(CoA_Reload, 26)
+WIRE_TYPE(A_Plant, 27)
+WIRE_TYPE(CoA_Plant, 28)
+WIRE_TYPE(A_Drop, 29)
+WIRE_TYPE(CoA_Drop, 30)
+WIRE_TYPE(C_Stuff, 31)
+WIRE_TYPE(C_Gun, 32)
+WIRE_TYPE(C_Mitraillette, 33)
+WIRE_TYPE(C_UltraM, 34)
+WIRE_TYPE(C_Knife, 35)
+WIRE_TYPE(C_Ammunition, 36)
+WIRE_TYPE(C_Bomb, 37)
+WIRE_TYPE(C_FakeStuff, 38)
+WIRE_TYPE(C_Flower, 39)
 
 #include "debug.h"
 
 using namespace std ;
 using namespace boost::archive ;
 
+size_t AbstractMessage::encode(char* buffer, size_t capacity) const {
+  const WireRegistry::Entry* entry = WireRegistry::find(std::type_index(typeid(*this))) ;
+  if(entry == NULL)
+    {
+      LOG(error) << "Message class not registered for the network : " << typeid(*this).name() ;
+      return 0 ;
+    }
+  WireWriter writer(buffer, capacity) ;
+  writer.write_varint(entry->id) ;
+  entry->encode(*this, writer) ;
+  return writer.size() ;
+}
+
+AbstractMessage* AbstractMessage::decode(const char* data, size_t size) {
+  WireReader reader(data, size) ;
+  unsigned int id = (unsigned int) reader.read_varint() ;
+  const WireRegistry::Entry* entry = reader.failed() ? NULL : WireRegistry::find(id) ;
+  if(entry == NULL)
+    return NULL ;
+  AbstractMessage* message = entry->decode(reader) ;
+  //trailing bytes mean the sender has another version of the class
+  if(reader.failed() || reader.remaining() != 0)
+    {
+      delete message ;
+      return NULL ;
+    }
+  return message ;
+}
+
 AbstractMessage* AbstractMessage::fromString(const std::string &msg){
-  try{
-  stringstream ss(msg) ;
-  AbstractMessage* message = NULL;
-  {
-    text_iarchive ar(ss) ;
-    ar >> message ;
-  }
-  DBG << "Deserialize from : " << msg ;
+  AbstractMessage* message = decode(msg.data(), msg.size()) ;
+  if(message == NULL)
+    LOG(error) << "Could not deserialize message of " << msg.size() << " bytes" ;
+  else
+    DBG << "Deserialized message of " << msg.size() << " bytes" ;
   return message ;
-  } catch(...) {
-    LOG(error) << "Could not deserialize message  : " << msg ;
-    return NULL ;
-  }
 }
 
 string AbstractMessage::toString() {
-  stringstream ss ;
-  {
-    text_oarchive ar(ss) ;
-    AbstractMessage * this2 = this;
-    ar << this2 ;
-  }
-  DBG << "Serialize to : " << ss.str() ;
-  return ss.str() ;
+  //most messages fit at once, the buffer grows for the others
+  static thread_local string buffer(256, '\000') ;
+  size_t size = encode(&buffer[0], buffer.size()) ;
+  if(size > buffer.size())
+    {
+      buffer.resize(size) ;
+      encode(&buffer[0], buffer.size()) ;
+    }
+  DBG << "Serialized to " << size << " bytes" ;
+  return buffer.substr(0, size) ;
 }
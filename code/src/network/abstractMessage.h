@@ -7,6 +7,7 @@
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/uuid_serialize.hpp>
 #include <string>
+#include <cstddef>
 #include <assert.h>
 
 /**
@@ -36,14 +37,16 @@ public :
 
   /**
    * @brief toString : serialize the object.
-   * @return The string representation of this message
+   * @return The string representation of this message, in the binary wire
+   * format (see encode)
    */
   virtual std::string toString() ;
 
   /**
    * @brief fromString : function used for deserialisation
    * @param msg : the string representation of the message
-   * @return The message created from its representation
+   * @return The message created from its representation, NULL if it could
+   * not be read
    * All classes inherited from AbstractMessage should implement
    * the function fromString with the signature :
    * static MsgType * fromString(std::string)
@@ -56,6 +59,25 @@ public :
    */
   virtual AbstractMessage* copy() =0 ;
 
+  /**
+   * @brief encode : serializes the message in the binary wire format
+   * (see wireCodec.h) into a buffer given by the caller.
+   * The class of the message must have been registered with WIRE_TYPE.
+   * @param buffer : where to write the message
+   * @param capacity : the size of the buffer
+   * @return the size of the message, 0 if its class is not registered.
+   * The message was only written if this is at most capacity.
+   */
+  size_t encode(char* buffer, size_t capacity) const ;
+
+  /**
+   * @brief decode : reads a message written by encode
+   * @param data : the bytes of the message
+   * @param size : the number of bytes
+   * @return a new message, NULL if the bytes are not a valid message
+   */
+  static AbstractMessage* decode(const char* data, size_t size) ;
+
   virtual ~AbstractMessage(){ }
 
 private :
@@ -17,7 +17,7 @@ using namespace boost::asio ;
 using namespace std ;
 
 
-ClientImplem::ClientImplem(ClientInfo &c_info) : ComunicatorImplem(), server_endpoint(),
+ClientImplem::ClientImplem(ClientInfo &c_info) : ComunicatorImplem(c_info.mtu), server_endpoint(),
   locStateUpdater(NULL){
 
     //connect socket
@@ -61,6 +61,7 @@ ClientImplem::ClientImplem(ClientInfo &c_info) : ComunicatorImplem(), server_end
     sock->connect(server_endpoint);
     NetEvent startMsg(NetEvent::SERV_TRY) ;
     this->sendMessage<NetEvent>(startMsg, false) ;
+    flush() ;
     wait_receive();
 }
 
@@ -73,20 +74,16 @@ ClientImplem::~ClientImplem(){
 
 void ClientImplem::send_message(AbstractMessage &msg, bool reliable, string msgType){
   last_sent ++ ;
-  //asynchronous send requires buffers to be saved on the heap as their
-  //content may be used after sock->async_send() returns.
-  //they are deleted when the callback on_sent is called
+  //the message is kept until it is acked, to be sent again.
+  //it is deleted by on_sent or check_ack
   string* header = create_header(reliable, msgType, last_sent) ;
   string* data = new string(msg.toString()) ;
-  vector<const_buffer> msg_buff ;
-  msg_buff.push_back(buffer(*header));
-  msg_buff.push_back(buffer(*data));
 
   vector<string*> buffers ;
   buffers.push_back(header);
   buffers.push_back(data);
 
-  write_buff(msg_buff, [this, buffers](const error_code& e, int i){on_sent(buffers, e,i) ;}) ;
+  queue_message(*header, *data, [this, buffers](const error_code& e, int i){on_sent(buffers, e,i) ;}) ;
 
   return ;
 }
@@ -171,9 +168,6 @@ void ClientImplem::on_sent(const std::vector<std::string *>& data, const boost::
 
 
 void ClientImplem::on_receive(const boost::system::error_code &error, int size){
-  int id = get_msg_id(*header_buff) ;
-  DBG << "CLI: Received Message with id " << id << " and type " << get_msg_type(*header_buff);
-
   if(error != 0)
     {
       generate_message(NetEvent(NetEvent::RECEIVE_ERR));
@@ -183,7 +177,23 @@ void ClientImplem::on_receive(const boost::system::error_code &error, int size){
   if(is_shutdown)
     return ;
 
-  if(ack_message(*header_buff))
+  size_t pos = 0 ;
+  string header, body ;
+  while(next_message(*buff, size, pos, header, body))
+    {
+      if(unpack(endpoint(), header, body))
+        handle_message(header, body) ;
+    }
+  //the ACKs and replies of the whole datagram go together
+  flush() ;
+  wait_receive() ;
+}
+
+void ClientImplem::handle_message(const string &header, const string &body){
+  int id = get_msg_id(header) ;
+  DBG << "CLI: Received Message with id " << id << " and type " << get_msg_type(header);
+
+  if(ack_message(header))
     {
         //Handle Ack
         NetEvent e(NetEvent::ACK) ;
@@ -195,7 +205,6 @@ void ClientImplem::on_receive(const boost::system::error_code &error, int size){
         if(!b)
           {
             //message dupicate
-            wait_receive() ;
             return ;
           }
         else
@@ -208,10 +217,15 @@ void ClientImplem::on_receive(const boost::system::error_code &error, int size){
             timer.async_wait(after_wait) ;
           }
     }
-    std::string type = get_msg_type(*header_buff) ;
+    std::string type = get_msg_type(header) ;
     if(type.compare(NetEvent::getMsgType()) == 0)
       {
-        NetEvent *event = (NetEvent *) AbstractMessage::fromString(buff->substr(0,size - HEADER_SIZE)) ;
+        NetEvent *event = (NetEvent *) AbstractMessage::fromString(body) ;
+        if(event == NULL)
+          {
+            LOG(error) << "CLI: NetEvent of " << body.size() << " bytes could not be read, ignored" ;
+            return ;
+          }
         DBG << "CLI: NetEvent received :" << *event ;
         switch(event->getType())
           {
@@ -290,7 +304,6 @@ void ClientImplem::on_receive(const boost::system::error_code &error, int size){
               if(ack_set.find(idrec) != ack_set.end())
                 ack_set.erase(idrec) ;
               delete event ;
-              wait_receive() ;
               return ;
               break ;
             }
@@ -298,9 +311,8 @@ void ClientImplem::on_receive(const boost::system::error_code &error, int size){
         delete event ;
       }
     received_messages_mutex.lock() ;
-    received_messages[type].push_back(buff->substr(0,size - HEADER_SIZE)) ;
+    received_messages[type].push_back(body) ;
     received_messages_mutex.unlock() ;
-    wait_receive() ;
 }
 
 
@@ -351,12 +363,9 @@ void ClientImplem::check_ack(std::vector<std::string*>& msg,
         {
           //Resend
           DBG << "CLI: No ACK received for message " << id  << " and type " << get_msg_type(*msg[0]) << ", re-sending message" ;
-          vector<const_buffer> msg_buff ;
-          for(string* p : msg)
-            msg_buff.push_back(buffer(*p));
-
-          //potentially dangerous : send can occur after the buffers are freed because ack received
-          write_buff(msg_buff, [](const error_code&,int){}) ;
+          //the message is copied in the datagram
+          queue_message(*msg[0], *msg[1], [](const error_code&,int){}) ;
+          flush() ;
           t->expires_from_now(boost::posix_time::millisec(TIME_TO_WAIT)) ;
           increase_tasks();
           t->async_wait(boost::bind(&ClientImplem::check_ack,this, msg, nb_times +1,t,_1)) ;
@@ -369,8 +378,7 @@ void ClientImplem::check_ack(std::vector<std::string*>& msg,
 void ClientImplem::wait_receive(){
   vector<mutable_buffer> vec ;
   //hack : using the underlying c_str of a string as a buffer (in theory, read only).
-  vec.push_back(buffer((char *) header_buff-> c_str(), HEADER_SIZE));
-  vec.push_back(buffer((char *) buff-> c_str(), BUFF_SIZE));
+  vec.push_back(buffer((char *) buff-> c_str(), MAX_DATAGRAM));
   sock->async_receive(vec, boost::bind(&ClientImplem::on_receive,this,_1,_2)) ;
 }
 
@@ -381,6 +389,7 @@ void ClientImplem::setLocalState(LocalState *simu) {
   NetEvent coevent(NetEvent::PLAYER_JOIN) ;
   coevent.setData(simu->getPlayer()->getID());
   sendMessage<NetEvent>(coevent) ;
+  flush() ;
 }
 
 void ClientImplem::update(sf::Time dt) {
@@ -388,4 +397,6 @@ void ClientImplem::update(sf::Time dt) {
     LOG(warning) << "CLIENT: Cannot update, no Local State attached" ;
   else
     locStateUpdater->update(dt);
+  //end of the tick : the messages queued are sent
+  flush() ;
 }
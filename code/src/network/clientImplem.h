@@ -32,10 +32,10 @@
  *  and wether it should be acked or not (1 bit).
  *  - data : provided by the toString method of the message
  *
- *  In pariticular, the size of the message sent is not sent. This is possible because
- *  we use a datagram oriented protocol. For this protocol to work, it is important that
- *  messages can be sent in only one datagram (and it should be checked that it is
- *  effectively the case).
+ *  Several messages are packed in a datagram, each one followed by the size of its
+ *  data (see ComunicatorImplem::queue_message). A message larger than a datagram
+ *  is split in fragments, which the other side reassembles : as one lost fragment
+ *  loses the whole message, messages should rather fit in one datagram.
  * @author mheinric
  */
 
@@ -92,6 +92,14 @@ protected :
      */
     void on_receive(const boost::system::error_code &error, int size) ;
 
+    /**
+     * @brief handle_message
+     * Called for each message of a received datagram, see on_receive
+     * @param header : the header of the message
+     * @param body : the body of the message
+     */
+    void handle_message(const std::string& header, const std::string& body) ;
+
     /**
      * @brief check_ack
      * function called to check wether an ACK was recieved for a
@@ -37,6 +37,11 @@ public :
   std::string localName ;
   std::string localPort ;
 
+  /**
+   * The size up to which messages are packed in a datagram.
+   */
+  unsigned int mtu ;
+
   /**
    * @brief ClientInfo : default constructors using default parameters
    */
@@ -45,6 +50,7 @@ public :
     serverPort = "1234" ;
     localName = "" ;
     localPort = -1 ;
+    mtu = 1400 ;
   }
 
   /**
@@ -56,6 +62,7 @@ public :
     serverPort = port ;
     localName = "" ;
     localPort = -1 ;
+    mtu = 1400 ;
   }
 
 } ;
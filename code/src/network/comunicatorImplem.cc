@@ -11,14 +11,28 @@
 using namespace std ;
 using namespace boost::asio ;
 
-ComunicatorImplem::ComunicatorImplem() : ack_set(), received_messages(), received_messages_mutex(),
+const int ComunicatorImplem::REASSEMBLY_TIMEOUT ;
+
+ComunicatorImplem::ComunicatorImplem(unsigned int mtu) : ack_set(), received_messages(), received_messages_mutex(),
   sent_ack(), lock(),
-  pending_writes(), can_write(true), last_sent(0), nb_tasks_mutex(){
+  pending_writes(), can_write(true), outgoing(), outgoing_lock(), mtu(mtu), last_fragmented(0), reassembly(), reassembly_size(0),
+  last_sent(0), nb_tasks_mutex(){
+  //below MIN_MTU, the size of a fragment would wrap
+  if(this->mtu < MIN_MTU)
+    {
+      LOG(error) << "NET: mtu of " << mtu << " bytes is too small, using " << MIN_MTU ;
+      this->mtu = MIN_MTU ;
+    }
+  //above MAX_DATAGRAM, the datagram could not be sent and the length of a body would wrap
+  if(this->mtu > MAX_DATAGRAM)
+    {
+      LOG(error) << "NET: mtu of " << mtu << " bytes is too large, using " << MAX_DATAGRAM ;
+      this->mtu = MAX_DATAGRAM ;
+    }
   //init fields
   service = new io_service() ;
   sock = new ip::udp::socket(*service) ;
-  buff = new string(BUFF_SIZE, '\000') ;
-  header_buff = new string(HEADER_SIZE, '\000') ;
+  buff = new string(MAX_DATAGRAM, '\000') ;
   work = new io_service::work(*service) ;
   net_thread = new thread([this](){service->run() ;}) ;
 }
@@ -28,12 +42,13 @@ ComunicatorImplem::~ComunicatorImplem(){
   delete sock ;
   delete service ;
   delete buff ;
-  delete header_buff ;
   delete net_thread ;
 }
 
 void ComunicatorImplem::shutdown(){
   DBG << "NET: Shutting down communication" ;
+  //the handlers of the messages still queued free their memory
+  flush() ;
   delete work ;
   work = NULL ;
   is_shutdown = true ;
@@ -146,6 +161,209 @@ void ComunicatorImplem::write_buff(vector<const_buffer> buffers,
   lock.unlock() ;
 }
 
+void ComunicatorImplem::queue_message(const string &header, const string &body,
+                                      boost::function<void(const error_code&, int)> handler,
+                                      endpoint* rec_endpoint) {
+  assert(header.size() == HEADER_SIZE) ;
+  endpoint destination = rec_endpoint == NULL ? endpoint() : *rec_endpoint ;
+  if(HEADER_SIZE + LENGTH_SIZE + body.size() <= mtu)
+    {
+      outgoing_lock.lock() ;
+      append_message(destination, header, body, handler) ;
+      outgoing_lock.unlock() ;
+      return ;
+    }
+
+  //too large for a datagram : split in fragments
+  size_t chunk = mtu - HEADER_SIZE - LENGTH_SIZE - FRAGMENT_HEADER ;
+  size_t count = (body.size() + chunk - 1) / chunk ;
+  if(body.size() > REASSEMBLY_SIZE || count >= 256*256)
+    {
+      LOG(error) << "NET: message of " << body.size() << " bytes is too large, not sent" ;
+      handler(boost::asio::error::message_size, 0) ;
+      return ;
+    }
+  outgoing_lock.lock() ;
+  last_fragmented++ ;
+  string* fragment_header = create_header(false, getFragmentType(), last_fragmented) ;
+  for(size_t i = 0 ; i < count ; i++)
+    {
+      string fragment(header) ;
+      for(int shift = 24 ; shift >= 0 ; shift -= 8)
+        fragment.push_back((char) ((last_fragmented >> shift) & 0xFF)) ;
+      fragment.push_back((char) (i/256)) ;
+      fragment.push_back((char) (i%256)) ;
+      fragment.push_back((char) (count/256)) ;
+      fragment.push_back((char) (count%256)) ;
+      fragment.append(body, i*chunk, chunk) ;
+      //the message is sent once its last fragment is
+      if(i + 1 == count)
+        append_message(destination, *fragment_header, fragment, handler) ;
+      else
+        append_message(destination, *fragment_header, fragment, [](const error_code&, int){}) ;
+    }
+  outgoing_lock.unlock() ;
+  delete fragment_header ;
+}
+
+void ComunicatorImplem::append_message(const endpoint &destination, const string &header, const string &body,
+                                       boost::function<void(const error_code&, int)> handler) {
+  size_t size = HEADER_SIZE + LENGTH_SIZE + body.size() ;
+  Datagram& datagram = outgoing[destination] ;
+  if(!datagram.data.empty() && datagram.data.size() + size > mtu)
+    send_datagram(destination, datagram) ;
+  datagram.data.append(header) ;
+  datagram.data.push_back((char) (body.size()/256)) ;
+  datagram.data.push_back((char) (body.size()%256)) ;
+  datagram.data.append(body) ;
+  datagram.handlers.push_back(handler) ;
+  //no room left for even an empty message
+  if(datagram.data.size() + HEADER_SIZE + LENGTH_SIZE > mtu)
+    send_datagram(destination, datagram) ;
+}
+
+void ComunicatorImplem::flush() {
+  outgoing_lock.lock() ;
+  for(auto& it : outgoing)
+    {
+      if(!it.second.data.empty())
+        send_datagram(it.first, it.second) ;
+    }
+  outgoing_lock.unlock() ;
+}
+
+void ComunicatorImplem::send_datagram(const endpoint &destination, Datagram &datagram) {
+  //asynchronous send requires that buffers are stored on the heap.
+  //it is freed once sent, after the handlers of its messages are called
+  Datagram* sent = new Datagram() ;
+  sent->data.swap(datagram.data) ;
+  sent->handlers.swap(datagram.handlers) ;
+  vector<const_buffer> buffers ;
+  buffers.push_back(buffer(sent->data)) ;
+  auto handler = [sent](const error_code& error, int size)
+    {
+      for(auto& h : sent->handlers)
+        h(error, size) ;
+      delete sent ;
+    } ;
+  endpoint rec_endpoint = destination ;
+  write_buff(buffers, handler, destination == endpoint() ? NULL : &rec_endpoint) ;
+}
+
+bool ComunicatorImplem::next_message(const string &datagram, size_t size, size_t &pos,
+                                     string &header, string &body) {
+  if(pos >= size)
+    return false ;
+  if(size - pos < HEADER_SIZE + LENGTH_SIZE)
+    {
+      LOG(warning) << "NET: truncated datagram" ;
+      return false ;
+    }
+  size_t length = 256 * (unsigned char) datagram[pos + HEADER_SIZE]
+      + (unsigned char) datagram[pos + HEADER_SIZE + 1] ;
+  if(size - pos - HEADER_SIZE - LENGTH_SIZE < length)
+    {
+      LOG(warning) << "NET: truncated datagram" ;
+      return false ;
+    }
+  header.assign(datagram, pos, HEADER_SIZE) ;
+  body.assign(datagram, pos + HEADER_SIZE + LENGTH_SIZE, length) ;
+  pos += HEADER_SIZE + LENGTH_SIZE + length ;
+  return true ;
+}
+
+bool ComunicatorImplem::unpack(const endpoint &from, string &header, string &body) {
+  if(get_msg_type(header).compare(getFragmentType()) != 0)
+    return true ;
+  if(body.size() <= FRAGMENT_HEADER)
+    {
+      LOG(warning) << "NET: truncated fragment" ;
+      return false ;
+    }
+
+  //the messages whose fragments are late are dropped
+  auto now = std::chrono::steady_clock::now() ;
+  for(auto it = reassembly.begin() ; it != reassembly.end() ; )
+    {
+      if(now - it->second.started > std::chrono::milliseconds(REASSEMBLY_TIMEOUT))
+        {
+          DBG << "NET: fragments of message " << it->first.second << " timed out" ;
+          auto old = it++ ;
+          drop_reassembly(old) ;
+        }
+      else
+        it++ ;
+    }
+
+  int id = 0 ;
+  for(int i = 0 ; i < 4 ; i++)
+    id = (id << 8) | (unsigned char) body[HEADER_SIZE + i] ;
+  unsigned int index = 256 * (unsigned char) body[HEADER_SIZE + 4] + (unsigned char) body[HEADER_SIZE + 5] ;
+  unsigned int count = 256 * (unsigned char) body[HEADER_SIZE + 6] + (unsigned char) body[HEADER_SIZE + 7] ;
+  if(index >= count)
+    {
+      LOG(warning) << "NET: invalid fragment" ;
+      return false ;
+    }
+
+  std::pair<endpoint, int> key(from, id) ;
+  auto it = reassembly.find(key) ;
+  if(it == reassembly.end())
+    {
+      Reassembly message ;
+      message.header = body.substr(0, HEADER_SIZE) ;
+      message.fragments.resize(count) ;
+      message.received.resize(count, false) ;
+      message.count = 0 ;
+      message.size = 0 ;
+      message.started = now ;
+      it = reassembly.insert(std::make_pair(key, message)).first ;
+    }
+  Reassembly& message = it->second ;
+  if(message.fragments.size() != count || message.received[index])
+    return false ;
+
+  //room for the fragment : the oldest messages go first
+  size_t size = body.size() - FRAGMENT_HEADER ;
+  while(reassembly_size + size > REASSEMBLY_SIZE)
+    {
+      auto oldest = reassembly.end() ;
+      for(auto other = reassembly.begin() ; other != reassembly.end() ; other++)
+        {
+          if(other != it && (oldest == reassembly.end() || other->second.started < oldest->second.started))
+            oldest = other ;
+        }
+      if(oldest == reassembly.end())
+        {
+          LOG(warning) << "NET: no room to reassemble message " << id ;
+          drop_reassembly(it) ;
+          return false ;
+        }
+      LOG(warning) << "NET: reassembly buffer full, dropping message " << oldest->first.second ;
+      drop_reassembly(oldest) ;
+    }
+  message.fragments[index] = body.substr(FRAGMENT_HEADER) ;
+  message.received[index] = true ;
+  message.count++ ;
+  message.size += size ;
+  reassembly_size += size ;
+  if(message.count < count)
+    return false ;
+
+  header = message.header ;
+  body.clear() ;
+  body.reserve(message.size) ;
+  for(const string& fragment : message.fragments)
+    body.append(fragment) ;
+  drop_reassembly(it) ;
+  return true ;
+}
+
+void ComunicatorImplem::drop_reassembly(std::map<std::pair<endpoint, int>, Reassembly>::iterator it) {
+  reassembly_size -= it->second.size ;
+  reassembly.erase(it) ;
+}
+
 void ComunicatorImplem::decrease_tasks(){
   nb_tasks_mutex.lock() ;
   nb_tasks-- ;
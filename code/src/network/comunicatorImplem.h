@@ -6,6 +6,8 @@
 #include <thread>
 #include <mutex>
 #include <queue>
+#include <map>
+#include <chrono>
 #include <boost/function.hpp>
 
 #include "netEvent.h"
@@ -15,13 +17,22 @@
  * Base class for the Network implementation of the client and the server.
  *
  * This class contains utility functions that are used on both sides.
+ *
+ * The messages are not sent one per datagram : queue_message packs them into
+ * a datagram per destination, sent when it is full (mtu bytes) or on flush,
+ * at the end of each tick. A datagram is a sequence of messages, each one a
+ * header (HEADER_SIZE), the size of the body (LENGTH_SIZE, big-endian) and
+ * the body, see next_message.
+ * A message which does not fit in a datagram is split into fragments, each
+ * one a message of type FRAGMENT_TYPE, and put back together on the other
+ * side, see unpack.
  * @author mheinric
  */
 class ComunicatorImplem
 {
 public:
 
-  ComunicatorImplem();
+  ComunicatorImplem(unsigned int mtu = DEFAULT_MTU);
   virtual ~ComunicatorImplem();
 
   /**
@@ -34,11 +45,61 @@ public:
 
   /**
    * @brief BUFF_SIZE
-   * size of the buffer used for recieve operations.
-   * messages should not have a greater size, this may cause problems
+   * size the messages should not exceed, so that they are sent in one datagram.
+   * Larger messages are split in fragments, which is slower and less reliable.
    */
   const static unsigned int BUFF_SIZE = 1000;
 
+  /**
+   * @brief LENGTH_SIZE : the size of the length of a message body in a datagram
+   */
+  const static unsigned int LENGTH_SIZE = 2 ;
+
+  /**
+   * @brief DEFAULT_MTU : the default size up to which messages are packed
+   * in a datagram, below the 1472 bytes of UDP payload of an ethernet frame
+   */
+  const static unsigned int DEFAULT_MTU = 1400 ;
+
+  /**
+   * @brief MAX_DATAGRAM : the largest UDP payload, the size of the receive buffer
+   * (the other side may use a greater mtu)
+   */
+  const static unsigned int MAX_DATAGRAM = 65507 ;
+
+  /**
+   * @brief FRAGMENT_HEADER : the size of the header of a fragment, in its body :
+   * the header of the message (HEADER_SIZE), its number (4 bytes), the index
+   * of the fragment and the number of fragments (2 bytes each)
+   */
+  const static unsigned int FRAGMENT_HEADER = HEADER_SIZE + 8 ;
+
+  /**
+   * @brief MIN_MTU : the smallest mtu, with which a fragment still carries
+   * one byte of the message. Smaller ones are raised to it, and larger ones than
+   * MAX_DATAGRAM are lowered to MAX_DATAGRAM.
+   */
+  const static unsigned int MIN_MTU = HEADER_SIZE + LENGTH_SIZE + FRAGMENT_HEADER + 1 ;
+
+  /**
+   * @brief REASSEMBLY_SIZE : the size of the fragments kept while waiting for the
+   * others, over all the messages. The oldest messages are dropped beyond it,
+   * larger messages are not sent.
+   */
+  const static unsigned int REASSEMBLY_SIZE = 1 << 20 ;
+
+  /**
+   * @brief REASSEMBLY_TIMEOUT
+   * time (in ms) after which a message whose fragments did not all arrive is dropped.
+   * A reliable message is sent again in between.
+   */
+  const static int REASSEMBLY_TIMEOUT = 1000 ;
+
+  /**
+   * @brief getFragmentType : the type in the header of the fragments
+   */
+  static std::string getFragmentType() { return std::string("Fragment") ; }
+
   /**
    * @brief TIME_TO_WAIT
    * time to wait (in ms) before resending the message.
@@ -96,16 +157,10 @@ protected :
 
   std::mutex received_messages_mutex ;
 
-  /**
-   * @brief header_buff
-   * Used as a buffer to temporarily store the header of received messages
-   */
-  std::string *header_buff ;
-
   /**
    * @brief buff
-   * Used as a buffer to temporarily store the results of
-   * recieve operations.
+   * Used as a buffer to temporarily store the datagrams
+   * recieved (MAX_DATAGRAM bytes).
    */
   std::string *buff ;
 
@@ -134,6 +189,59 @@ protected :
    */
   bool can_write ;
 
+  /**
+   * @brief The Datagram struct : messages waiting to be sent together
+   */
+  struct Datagram {
+    std::string data ;
+    //the handlers of the messages, called when the datagram is sent
+    std::vector< boost::function<void(const error_code&, int)> > handlers ;
+  };
+
+  /**
+   * @brief outgoing : the datagram being filled for each destination
+   * (endpoint() when the socket is connected)
+   */
+  std::map<endpoint, Datagram> outgoing ;
+
+  /**
+   * @brief outgoing_lock : used to prevent concurrent access to outgoing
+   */
+  std::mutex outgoing_lock ;
+
+  /**
+   * @brief mtu : the size up to which messages are packed in a datagram
+   */
+  unsigned int mtu ;
+
+  /**
+   * @brief last_fragmented : number attributed to the last message split in fragments
+   */
+  int last_fragmented ;
+
+  /**
+   * @brief The Reassembly struct : the fragments received of a message
+   */
+  struct Reassembly {
+    std::string header ;
+    std::vector<std::string> fragments ;
+    std::vector<bool> received ;
+    unsigned int count ;
+    size_t size ;
+    std::chrono::steady_clock::time_point started ;
+  };
+
+  /**
+   * @brief reassembly : the messages being put back together, by sender and number.
+   * Only used by the thread running the receive operations.
+   */
+  std::map<std::pair<endpoint, int>, Reassembly> reassembly ;
+
+  /**
+   * @brief reassembly_size : the size of the fragments in reassembly
+   */
+  size_t reassembly_size ;
+
   /**
    * @brief last_sent : number attributed to the last sent message
    */
@@ -224,6 +332,50 @@ protected :
                   boost::function<void(const error_code&, int)> handler,
                   endpoint* rec_endpoint = NULL) ;
 
+  /**
+   * @brief queue_message : adds a message to the datagram sent to the given endpoint.
+   * The datagram is sent before if the message does not fit in it, and after if it
+   * is then full. A message larger than the mtu is split in fragments (see
+   * FRAGMENT_HEADER), each queued like a message ; the handler is called once the
+   * last one is sent.
+   * The header and the body are copied, they can be destroyed immediately.
+   * @param header : the header of the message, see create_header
+   * @param body : the body of the message
+   * @param handler : called once the datagram is sent
+   * @param rec_endpoint : the endpoint to send the message to, default to NULL, meaning the socket is already connected
+   */
+  void queue_message(const std::string& header, const std::string& body,
+                     boost::function<void(const error_code&, int)> handler,
+                     endpoint* rec_endpoint = NULL) ;
+
+  /**
+   * @brief flush : sends the datagrams of all the messages queued
+   */
+  void flush() ;
+
+  /**
+   * @brief next_message : reads a message of a received datagram
+   * @param datagram : the datagram
+   * @param size : the size of the datagram
+   * @param pos : where the message starts, moved to the next one
+   * @param header : set to the header of the message
+   * @param body : set to the body of the message
+   * @return false if there is no message left, or if the datagram is truncated
+   */
+  bool next_message(const std::string& datagram, size_t size, size_t& pos,
+                    std::string& header, std::string& body) ;
+
+  /**
+   * @brief unpack : handles the fragments among the messages read by next_message.
+   * A fragment is kept until all the fragments of its message are received, the
+   * last one is then replaced by the whole message.
+   * @param from : the sender of the message (endpoint() when the socket is connected)
+   * @param header : the header of the message read, replaced by the one of the whole message
+   * @param body : the body of the message read, replaced by the one of the whole message
+   * @return true if header and body are a message to handle, false if they were a fragment kept
+   */
+  bool unpack(const endpoint& from, std::string& header, std::string& body) ;
+
   /**
    * @brief increase_tasks : increases the counter of pending tasks
    */
@@ -234,6 +386,25 @@ protected :
    */
   void decrease_tasks() ;
 
+private :
+  /**
+   * @brief send_datagram : sends a datagram, which is emptied
+   * (outgoing_lock must be held)
+   */
+  void send_datagram(const endpoint& destination, Datagram& datagram) ;
+
+  /**
+   * @brief append_message : adds a message to the datagram sent to the given endpoint,
+   * see queue_message (outgoing_lock must be held)
+   */
+  void append_message(const endpoint& destination, const std::string& header, const std::string& body,
+                      boost::function<void(const error_code&, int)> handler) ;
+
+  /**
+   * @brief drop_reassembly : forgets a message being put back together
+   */
+  void drop_reassembly(std::map<std::pair<endpoint, int>, Reassembly>::iterator it) ;
+
 };
 
 #endif // COMUNICATORIMPLEM_H
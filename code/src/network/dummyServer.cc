@@ -2,6 +2,7 @@
 #include "dummyServer.h"
 #include "dummyClient.h"
 #include "gameUpdate.h"
+#include "comunicatorImplem.h"
 
 /*
  * @author mheinric
@@ -156,6 +157,11 @@ bool DummyServer::isConnected(int player){
   return players.find(player) != players.end() ;
 }
 
+unsigned int DummyServer::getMtu(){
+  //no datagram here : the same size as a real server
+  return ComunicatorImplem::DEFAULT_MTU ;
+}
+
 void DummyServer::setSimulation(GlobalState *simu) {
   if(updateGen != NULL)
     LOG(error) << "SERVER: Simulation already set" ;
@@ -107,6 +107,8 @@ public :
 
     virtual bool isConnected(int player) ;
 
+    virtual unsigned int getMtu() ;
+
     virtual void setSimulation(GlobalState * simu) ;
 
     virtual void update(sf::Time dt) ;
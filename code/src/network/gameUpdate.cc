@@ -5,7 +5,8 @@
  * @author mheinric
  */
 
-GameUpdate::GameUpdate() : p_update(), npc_updates(){}
+GameUpdate::GameUpdate() : sequence(0), baseline(-1), part(0), parts(1),
+  p_update(), npc_updates(), removed(){}
 
 GameUpdate::~GameUpdate(){}
 
@@ -18,17 +19,20 @@ void GameUpdate::addNpcUpdate(const NpcUpdate &npcUpdate) {
   return ;
 }
 
+void GameUpdate::addRemoved(const boost::uuids::uuid &id) {
+  removed.push_back(id);
+  return ;
+}
+
+std::vector<NpcUpdate> GameUpdate::getNpcUpdates() {
+  return npc_updates ;
+}
+
 PlayerUpdate& GameUpdate::getPlayerUpdate(){
   return p_update ;
 }
 
 
 GameUpdate * GameUpdate::copy(){
-  GameUpdate * update = new GameUpdate() ;
-  update->setPlayerUpdate(this->getPlayerUpdate());
-  for(NpcUpdate npc_update : this->npc_updates)
-    {
-      update->addNpcUpdate(npc_update);
-    }
-  return update ;
+  return new GameUpdate(*this) ;
 }
@@ -3,15 +3,29 @@
 
 #include <string>
 #include <vector>
+#include <unordered_map>
+#include <boost/functional/hash.hpp>
+#include <boost/serialization/vector.hpp>
 
 #include "abstractMessage.h"
 #include "npcUpdate.h"
 #include "playerUpdate.h"
 
+/**
+ * @brief NpcStates : the state of every NPC of a snapshot, by uuid
+ */
+typedef std::unordered_map<boost::uuids::uuid, NpcUpdate, boost::hash<boost::uuids::uuid> > NpcStates ;
+
 /**
  * @brief The GameUpdate class
  * Will contain informations to transmit to the clients
  * Will be created from the GameState.
+ *
+ * A GameUpdate is one part of a snapshot of the NPCs, see UpdateGenerator :
+ * the NPCs which appeared or changed since the snapshot baseline, which the
+ * client has acknowledged (see SnapshotAck), and the ones which disappeared.
+ * A snapshot too large for one datagram is split into several parts, each
+ * with its own NPCs ; the client uses it once all of them are received.
  * @author mheinric
  */
 
@@ -58,11 +72,42 @@ public:
      */
     std::vector<NpcUpdate> getNpcUpdates() ;
 
+    /**
+     * @brief npcUpdates
+     * @return the NPC updates in the message, without copying them
+     */
+    const std::vector<NpcUpdate>& npcUpdates() const { return npc_updates ; }
+
+    /**
+     * @brief addRemoved : adds a NPC which does not exist any more
+     */
+    void addRemoved(const boost::uuids::uuid& id) ;
+
+    const std::vector<boost::uuids::uuid>& getRemoved() const { return removed ; }
+
+    /**
+     * @brief sequence : the number of the snapshot, increasing
+     */
+    int sequence ;
+
+    /**
+     * @brief baseline : the number of the snapshot the NPC updates are relative to,
+     * -1 if the updates carry every NPC
+     */
+    int baseline ;
+
+    /**
+     * @brief part, parts : this update is the part-th of the parts ones of the snapshot
+     */
+    int part ;
+    int parts ;
+
 private :
     PlayerUpdate p_update ;
     std::vector<NpcUpdate> npc_updates ;
+    std::vector<boost::uuids::uuid> removed ;
 
-    SIMPLE_MESSAGE(GameUpdate, AbstractMessage, p_update)
+    SIMPLE_MESSAGE(GameUpdate, AbstractMessage, p_update, sequence, baseline, part, parts, npc_updates, removed)
 };
 
 #endif // GAMEUPDATE_H
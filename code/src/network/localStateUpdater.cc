@@ -1,6 +1,8 @@
 #include <cmath>
 
 #include "localStateUpdater.h"
+#include "snapshotAck.h"
+#include "updateGenerator.h"
 #include "simulation/localState.h"
 
 #define DEBUG false
@@ -14,7 +16,8 @@ using namespace std ;
 
 
 LocalStateUpdater::LocalStateUpdater(LocalState* state, Client* client) :
-  localState(state), client(client), lastUpdate(sf::Time::Zero), diffPos()
+  localState(state), client(client), lastUpdate(sf::Time::Zero), diffPos(),
+  assembling(), snapshots(), applied(-1)
 {
 }
 
@@ -30,7 +33,27 @@ void LocalStateUpdater::update(sf::Time dt){
       lastUpdate = sf::Time::Zero ;
     }
   for(GameUpdate * l_update : updates)
-      delete l_update ;
+    {
+      if(l_update->sequence <= applied || l_update->part < 0 || l_update->part >= l_update->parts)
+        {
+          delete l_update ;
+          continue ;
+        }
+      std::vector<GameUpdate*>& parts = assembling[l_update->sequence] ;
+      parts.push_back(l_update) ;
+      if((int) parts.size() == l_update->parts)
+        {
+          applySnapshot(parts) ;
+          //the parts of this snapshot and of the older ones are no longer needed
+          int sequence = l_update->sequence ;
+          for(auto it = assembling.begin() ; it != assembling.end() && it->first <= sequence ; )
+            {
+              for(GameUpdate* part : it->second)
+                delete part ;
+              it = assembling.erase(it) ;
+            }
+        }
+    }
   lastUpdate += dt ;
   updatePlayerPosition(dt) ;
 
@@ -69,7 +92,78 @@ void LocalStateUpdater::applyPlayerUpdate(PlayerUpdate &p_update, sf::Time dt){
   return ;
 }
 
+void LocalStateUpdater::applySnapshot(vector<GameUpdate*>& parts){
+  int sequence = parts.front()->sequence ;
+  int baseline = parts.front()->baseline ;
+  shared_ptr<NpcStates> state ;
+  if(baseline < 0)
+    state = std::make_shared<NpcStates>() ;
+  else
+    {
+      auto base = snapshots.find(baseline) ;
+      if(base == snapshots.end())
+        {
+          LOG(warning) << "Local Updater : baseline " << baseline << " of snapshot " << sequence << " unknown" ;
+          return ;
+        }
+      state = std::make_shared<NpcStates>(*base->second) ;
+    }
+
+  for(GameUpdate* part : parts)
+    {
+      for(const NpcUpdate& npc_update : part->npcUpdates())
+        {
+          if(npc_update.isCreated)
+            (*state)[npc_update.id] = npc_update ;
+          else
+            {
+              auto it = state->find(npc_update.id) ;
+              if(it == state->end())
+                {
+                  LOG(warning) << "Local Updater : snapshot " << sequence << " changes an unknown NPC" ;
+                  return ;
+                }
+              it->second.merge(npc_update) ;
+            }
+        }
+      for(const boost::uuids::uuid& id : part->getRemoved())
+        state->erase(id) ;
+    }
+  snapshots[sequence] = state ;
+  SnapshotAck ack(localState->getOwner().getID(), sequence) ;
+  client->sendMessage<SnapshotAck>(ack, false) ;
+
+  //only what changed since the last snapshot applied goes to the local state
+  static const NpcStates empty ;
+  auto last = snapshots.find(applied) ;
+  const NpcStates& before = last == snapshots.end() ? empty : *last->second ;
+  for(const auto& entry : *state)
+    {
+      auto old = before.find(entry.first) ;
+      NpcUpdate npc_update = entry.second ;
+      //created if it is missing here, whatever the reason
+      npc_update.isCreated = true ;
+      npc_update.fields = old == before.end() ? NpcUpdate::ALL : NpcUpdate::changes(old->second, entry.second) ;
+      if(npc_update.fields != 0)
+        applyNpcUpdate(npc_update) ;
+    }
+  for(const auto& entry : before)
+    {
+      if(state->count(entry.first) == 0)
+        localState->removeNpc(entry.first) ;
+    }
+  applied = sequence ;
+
+  //the next baselines are at least as recent as this one
+  snapshots.erase(snapshots.begin(), snapshots.lower_bound(baseline)) ;
+  while(snapshots.size() > (size_t) UpdateGenerator::HISTORY)
+    snapshots.erase(snapshots.begin()) ;
+  return ;
+}
+
 void LocalStateUpdater::applyNpcUpdate(NpcUpdate &npc_update){
+  localState->applyNpcUpdate(npc_update) ;
+  return ;
 }
 
 void LocalStateUpdater::updatePlayerPosition(sf::Time dt) {
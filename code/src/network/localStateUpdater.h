@@ -1,6 +1,10 @@
 #ifndef LOCALSTATEUPDATER_H
 #define LOCALSTATEUPDATER_H
+#include <map>
+#include <memory>
+#include <vector>
 #include "client.h"
+#include "gameUpdate.h"
 #include "playerUpdate.h"
 #include "npcUpdate.h"
 
@@ -26,6 +30,8 @@ public:
    * This function performs the following :
    *  -> call receiveMessages<GameUpdate>() on the client
    *  -> apply the received updates to the local state.
+   * The NPCs are applied once all the parts of a snapshot are received, the
+   * snapshot is then acknowledged to the server (see SnapshotAck).
    */
   void update(sf::Time dt) ;
 
@@ -43,6 +49,29 @@ private :
    */
   Position diffPos ;
 
+  /**
+   * @brief assembling : the parts received of the snapshots not complete yet, by sequence
+   */
+  std::map<int, std::vector<GameUpdate*> > assembling ;
+
+  /**
+   * @brief snapshots : the state of the NPCs in the snapshots received, which
+   * can still be the baseline of the next ones, by sequence
+   */
+  std::map<int, std::shared_ptr<NpcStates> > snapshots ;
+
+  /**
+   * @brief applied : the sequence of the snapshot applied to the local state, -1 if none
+   */
+  int applied ;
+
+  /**
+   * @brief applySnapshot : rebuilds the state of a complete snapshot from its
+   * baseline, acknowledges it and applies what changed since the last one applied
+   * @param parts : all the parts of the snapshot
+   */
+  void applySnapshot(std::vector<GameUpdate*>& parts) ;
+
   void applyPlayerUpdate(PlayerUpdate &p_update, sf::Time dt) ;
   void applyNpcUpdate(NpcUpdate & npc_update) ;
 
@@ -8,7 +8,7 @@
  * @author mheinric
  */
 
-NpcUpdate::NpcUpdate() : isCreated(false), id(),
+NpcUpdate::NpcUpdate() : isCreated(false), fields(ALL), id(),
   currentPosition(), target(), fear(),
   shocked(false), speed(), hitboxSize(), deltaT(), lambda(), Vzero(),
   dying(), dead(), deathTimeout(), textPackID()
@@ -16,7 +16,7 @@ NpcUpdate::NpcUpdate() : isCreated(false), id(),
 }
 
 
-NpcUpdate::NpcUpdate(NPC &npc, bool is_created) : isCreated(is_created), id(npc.uuid), currentPosition(npc.position), target(npc.target),
+NpcUpdate::NpcUpdate(NPC &npc, bool is_created) : isCreated(is_created), fields(ALL), id(npc.uuid), currentPosition(npc.position), target(npc.target),
   fear(npc.getFear()), shocked(npc.isShocked()), speed(npc.getSpeed()),
   hitboxSize(npc.hitboxSize), deltaT(npc.deltaT), lambda(npc.lambda), Vzero(npc.Vzero),
   dying(npc.dying), dead(npc.dead), deathTimeout(npc.deathTimeout.asSeconds()), textPackID(npc.anim.getTexID())
@@ -43,22 +43,74 @@ NPC* NpcUpdate::createNpc() {
 }
 
 void NpcUpdate::updateNpc(NPC& npc) {
-  assert(!isCreated) ;
-  npc.speed = speed;
-  npc.setFear(fear);
-  npc.hitboxSize = hitboxSize;
-  npc.setPosition(currentPosition) ;
-  npc.setShocked(shocked);
-  npc.speed = speed ;
-  npc.deltaT = deltaT ;
-  npc.lambda = lambda ;
-  npc.Vzero = Vzero ;
-  npc.dying = dying ;
-  npc.dead = dead ;
-  npc.deathTimeout = sf::seconds(deathTimeout) ;
+  if(fields & POSITION)
+    npc.setPosition(currentPosition) ;
+  if(fields & FEAR)
+    {
+      npc.setFear(fear);
+      npc.setShocked(shocked);
+    }
+  if(fields & STATE)
+    {
+      npc.dying = dying ;
+      npc.dead = dead ;
+      npc.deathTimeout = sf::seconds(deathTimeout) ;
+    }
+  if(fields & MOTION)
+    {
+      npc.speed = speed ;
+      npc.hitboxSize = hitboxSize;
+      npc.deltaT = deltaT ;
+      npc.lambda = lambda ;
+      npc.Vzero = Vzero ;
+    }
+  npc.syncStore();
   /*
   * FIXME updating texture anim doesn't work.
   * Inferno cops become invisible on the client
   * npc.TextureAnim(textures::get(textPackID));
   */
 }
+
+unsigned int NpcUpdate::changes(const NpcUpdate& before, const NpcUpdate& after) {
+  unsigned int changed = 0 ;
+  if(before.currentPosition.getX() != after.currentPosition.getX()
+     || before.currentPosition.getY() != after.currentPosition.getY())
+    changed |= POSITION ;
+  if(before.target.getX() != after.target.getX() || before.target.getY() != after.target.getY())
+    changed |= TARGET ;
+  if(before.fear != after.fear || before.shocked != after.shocked)
+    changed |= FEAR ;
+  if(before.dying != after.dying || before.dead != after.dead || before.deathTimeout != after.deathTimeout)
+    changed |= STATE ;
+  if(before.speed != after.speed || before.hitboxSize != after.hitboxSize || before.deltaT != after.deltaT
+     || before.lambda != after.lambda || before.Vzero != after.Vzero)
+    changed |= MOTION ;
+  return changed ;
+}
+
+void NpcUpdate::merge(const NpcUpdate& delta) {
+  if(delta.fields & POSITION)
+    currentPosition = delta.currentPosition ;
+  if(delta.fields & TARGET)
+    target = delta.target ;
+  if(delta.fields & FEAR)
+    {
+      fear = delta.fear ;
+      shocked = delta.shocked ;
+    }
+  if(delta.fields & STATE)
+    {
+      dying = delta.dying ;
+      dead = delta.dead ;
+      deathTimeout = delta.deathTimeout ;
+    }
+  if(delta.fields & MOTION)
+    {
+      speed = delta.speed ;
+      hitboxSize = delta.hitboxSize ;
+      deltaT = delta.deltaT ;
+      lambda = delta.lambda ;
+      Vzero = delta.Vzero ;
+    }
+}
@@ -11,11 +11,23 @@ class GraphicContextIso ;
 
 /**
  * @brief The NpcUpdate class : Container for informations that will be passed as an update through the network.
+ * An update may carry only some groups of fields (see fields), the others
+ * being left unchanged when it is applied : this is how the snapshots only
+ * send what changed (see UpdateGenerator).
  * @author mheinric
  */
 class NpcUpdate : public AbstractMessage
 {
 public:
+  /*
+   * The groups of fields, bits of fields
+   */
+  static const unsigned int POSITION = 1 ; // currentPosition
+  static const unsigned int TARGET = 2 ;   // target
+  static const unsigned int FEAR = 4 ;     // fear, shocked
+  static const unsigned int STATE = 8 ;    // dying, dead, deathTimeout
+  static const unsigned int MOTION = 16 ;  // speed, hitboxSize, deltaT, lambda, Vzero
+  static const unsigned int ALL = 31 ;
   /**
    * @brief NpcUpdate : creates an update from the given NPC
    * @param npc : the npc to store informations about.
@@ -34,16 +46,34 @@ public:
 
   /**
    * @brief update given NPC using this update's values.
-   * The field isCreated must be false. It it is, it will fail.
+   * Only the fields carried by the update are changed.
    */
   void updateNpc(NPC& npc);
 
+  /**
+   * @brief changes : compares two updates of the same NPC
+   * @return the groups of fields whose values differ
+   */
+  static unsigned int changes(const NpcUpdate& before, const NpcUpdate& after) ;
+
+  /**
+   * @brief merge : copies the fields carried by another update of the same NPC
+   * @param delta : the other update
+   */
+  void merge(const NpcUpdate& delta) ;
+
 
   /**
    * @brief isCreated : true if this message correspond to the creation of the NPC
    */
   bool isCreated ;
 
+  /**
+   * @brief fields : the groups of fields carried by this update, always ALL
+   * if isCreated
+   */
+  unsigned int fields ;
+
   /*
    * The following fields corresponds to those of the NPC class
    */
@@ -79,9 +109,23 @@ private :
   {
     ar & boost::serialization::base_object<AbstractMessage>(*this);
     ar & isCreated ;
-    __serialize_variables(ar, id, currentPosition, target, fear, shocked, dying, dead, deathTimeout) ;
+    ar & id ;
+    if(isCreated)
+      fields = ALL ;
+    else
+      ar & fields ;
+    if(fields & POSITION)
+      ar & currentPosition ;
+    if(fields & TARGET)
+      ar & target ;
+    if(fields & FEAR)
+      __serialize_variables(ar, fear, shocked) ;
+    if(fields & STATE)
+      __serialize_variables(ar, dying, dead, deathTimeout) ;
+    if(fields & MOTION)
+      __serialize_variables(ar, speed, hitboxSize, deltaT, lambda, Vzero) ;
     if(isCreated)
-      __serialize_variables(ar, speed, hitboxSize, deltaT, lambda, Vzero, textPackID) ;
+      ar & textPackID ;
   }
 };
 
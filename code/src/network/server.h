@@ -100,6 +100,14 @@ public :
    */
   virtual bool isConnected(int player) = 0 ;
 
+  /**
+   * @brief getMtu : the size up to which messages are packed in a datagram.
+   * A message should not exceed getMtu() minus the header and the length of a
+   * message (see ComunicatorImplem) to be sent without being split in fragments.
+   * @return the mtu of the server, in bytes
+   */
+  virtual unsigned int getMtu() = 0 ;
+
 
   /**
    * @brief setSimulation : sets the simulation associated with this server instance.
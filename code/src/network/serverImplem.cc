@@ -17,8 +17,8 @@ using namespace std ;
 using namespace boost::asio ;
 
 
-ServerImplem::ServerImplem(ServerInfo& s_info) : ComunicatorImplem(),
-  client_endpoints(), registered_players(), sender_endpoint() {
+ServerImplem::ServerImplem(ServerInfo& s_info) : ComunicatorImplem(s_info.mtu),
+  client_endpoints(), registered_players(), sender_endpoint(), snapshot_rate(s_info.snapshot_rate) {
 
   //connect socket
   ip::udp::resolver resolver(*service) ;
@@ -59,6 +59,10 @@ bool ServerImplem::isConnected(int player){
   return registered_players.find(player) != registered_players.end() ;
 }
 
+unsigned int ServerImplem::getMtu(){
+  return mtu ;
+}
+
 void ServerImplem::send_message(AbstractMessage &msg, bool reliable, string msgType, int player){
   if(player == -1)
     {
@@ -66,20 +70,17 @@ void ServerImplem::send_message(AbstractMessage &msg, bool reliable, string msgT
       for(endpoint cli_endpoint : client_endpoints)
         {
           last_sent++ ;
-          //asynchronous send requires that buffers are stored on the heap.
-          //they are freed when the callback on_sent is called
+          //the message is kept until it is acked, to be sent again.
+          //it is freed by on_sent or check_ack
           string* header = create_header(reliable, msgType, last_sent) ;
           string* data = new string(msg.toString()) ;
 
           vector<string *> string_msg ;
           string_msg.push_back(header);
           string_msg.push_back(data);
-          vector<const_buffer>buffs ;
-          buffs.push_back(buffer(*string_msg[0]));
-          buffs.push_back(buffer(*string_msg[1]));
 
           auto handler = boost::bind(&ServerImplem::on_sent, this,string_msg,cli_endpoint, _1, _2) ;
-          write_buff(buffs, handler, &cli_endpoint) ;
+          queue_message(*header, *data, handler, &cli_endpoint) ;
         }
     }
   else
@@ -91,12 +92,9 @@ void ServerImplem::send_message(AbstractMessage &msg, bool reliable, string msgT
       vector<string *> string_msg ;
       string_msg.push_back(header);
       string_msg.push_back(data);
-      vector<const_buffer>buffs ;
-      buffs.push_back(buffer(*string_msg[0]));
-      buffs.push_back(buffer(*string_msg[1]));
       endpoint cli_endpoint = registered_players.at(player) ;
       auto handler = boost::bind(&ServerImplem::on_sent, this,string_msg,cli_endpoint, _1, _2) ;
-      write_buff(buffs, handler, &cli_endpoint) ;
+      queue_message(*header, *data, handler, &cli_endpoint) ;
     }
 }
 
@@ -181,8 +179,6 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
   if(client_endpoints.insert(sender_endpoint).second)
     DBG << "SERVER: Added new Client with address : "
            << sender_endpoint.address().to_string() << ":" << sender_endpoint.port();
-  int id = get_msg_id(*header_buff) ;
-  DBG << "SERVER: Received message with id : " << id << " and type " << get_msg_type(*header_buff) ;
 
   if(is_shutdown)
     return ;
@@ -194,7 +190,23 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
       wait_receive() ;
       return ;
     }
-  if(ack_message(*header_buff))
+  size_t pos = 0 ;
+  string header, body ;
+  while(next_message(*buff, size, pos, header, body))
+    {
+      if(unpack(sender_endpoint, header, body))
+        handle_message(header, body) ;
+    }
+  //the ACKs and replies of the whole datagram go together
+  flush() ;
+  wait_receive() ;
+}
+
+void ServerImplem::handle_message(const string &header, const string &body){
+  int id = get_msg_id(header) ;
+  DBG << "SERVER: Received message with id : " << id << " and type " << get_msg_type(header) ;
+
+  if(ack_message(header))
     {
       //Handle Ack
       NetEvent e(NetEvent::ACK) ;
@@ -208,7 +220,6 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
         {
           //message dupicate
           DBG << "SERVER: Message received is a duplicate" ;
-          wait_receive() ;
           return ;
         }
       else
@@ -221,10 +232,15 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
           timer.async_wait(after_wait) ;
         }
       }
-  std::string type = get_msg_type(*header_buff) ;
+  std::string type = get_msg_type(header) ;
   if(type.compare(NetEvent::getMsgType()) == 0)
     {
-      NetEvent *event = (NetEvent *) AbstractMessage::fromString(buff->substr(0,size - HEADER_SIZE)) ;
+      NetEvent *event = (NetEvent *) AbstractMessage::fromString(body) ;
+      if(event == NULL)
+        {
+          LOG(error) << "SERVER: NetEvent of " << body.size() << " bytes could not be read, ignored" ;
+          return ;
+        }
 
       DBG << "SERVER: NetEvent received : " << *event ;
       switch(event->getType())
@@ -245,18 +261,10 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
           {
             //Not using sendMessage, because don't know player id to send to...
             NetEvent reply(NetEvent::SERV_RESP) ;
-            string *msg_body = new string(reply.toString()) ;
             last_sent ++ ;
             string *msg_header = create_header(false, NetEvent::getMsgType(), last_sent) ;
-            vector<const_buffer> buffers ;
-            buffers.push_back(buffer(*msg_header));
-            buffers.push_back(buffer(*msg_body));
-            auto handler = [this, msg_header, msg_body](const error_code&, int)
-                                {
-                                   delete msg_header ;
-                                   delete msg_body ;
-                                } ;
-            write_buff(buffers, handler, &sender_endpoint);
+            queue_message(*msg_header, reply.toString(), [](const error_code&, int){}, &sender_endpoint);
+            delete msg_header ;
             break ;
           }
 
@@ -319,7 +327,6 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
             if(ack_set.find(idrec) != ack_set.end())
               ack_set.erase(idrec) ;
             delete event ;
-            wait_receive() ;
             return ;
             break ;
           }
@@ -327,9 +334,8 @@ void ServerImplem::on_receive(const boost::system::error_code &error, int size){
         delete event ;
     }
   received_messages_mutex.lock() ;
-  received_messages[type].push_back(buff->substr(0,size - HEADER_SIZE)) ;
+  received_messages[type].push_back(body) ;
   received_messages_mutex.unlock() ;
-  wait_receive() ;
 }
 
 
@@ -375,11 +381,8 @@ void ServerImplem::check_ack(std::vector<std::string*>& msg, endpoint cli_endpoi
         {
           //Resend
           DBG << "SERVER: No ACK, resending message with id : " << id << "and type " << get_msg_type(*msg[0]);
-          vector<const_buffer> msg_buff ;
-          for(string* p : msg)
-            msg_buff.push_back(buffer(*p));
-
-          write_buff(msg_buff,[this](boost::system::error_code,int){}, &cli_endpoint) ;
+          queue_message(*msg[0], *msg[1], [](const error_code&, int){}, &cli_endpoint) ;
+          flush() ;
           t->expires_from_now(boost::posix_time::millisec(TIME_TO_WAIT)) ;
           increase_tasks();
           t->async_wait(boost::bind(&ServerImplem::check_ack,this, msg, cli_endpoint,nb_times +1,t,_1)) ;
@@ -391,15 +394,14 @@ void ServerImplem::check_ack(std::vector<std::string*>& msg, endpoint cli_endpoi
 void ServerImplem::wait_receive(){
   vector<mutable_buffer> vec ;
   //hack : using the underlying c_str of a string as a buffer (in theory, read only).
-  vec.push_back(buffer((char *) header_buff-> c_str(), HEADER_SIZE));
-  vec.push_back(buffer((char *) buff-> c_str(), BUFF_SIZE));
+  vec.push_back(buffer((char *) buff-> c_str(), MAX_DATAGRAM));
   sock->async_receive_from(vec, sender_endpoint, boost::bind(&ServerImplem::on_receive,this,_1,_2)) ;
 }
 
 void ServerImplem::setSimulation(GlobalState *simu) {
   if(updateGen != NULL)
     LOG(error) << "SERVER: Simulation already set" ;
-  updateGen = new UpdateGenerator(simu, this) ;
+  updateGen = new UpdateGenerator(simu, this, snapshot_rate) ;
 }
 
 void ServerImplem::update(sf::Time dt) {
@@ -407,4 +409,6 @@ void ServerImplem::update(sf::Time dt) {
     LOG(warning) << "SERVER: Cannot update, no Simulation attached" ;
   else
     updateGen->update(dt);
+  //end of the tick : the messages queued are sent
+  flush() ;
 }
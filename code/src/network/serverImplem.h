@@ -29,6 +29,8 @@ public :
 
     virtual bool isConnected(int player) ;
 
+    virtual unsigned int getMtu() ;
+
     virtual void setSimulation(GlobalState *simu) ;
 
     virtual void update(sf::Time dt) ;
@@ -65,6 +67,11 @@ protected :
 
     UpdateGenerator* updateGen ;
 
+    /**
+     * @brief snapshot_rate : the rate of the updateGen, see ServerInfo
+     */
+    float snapshot_rate ;
+
     /**
     * @brief on_sent
     * Function called after a send operation has been made.
@@ -80,6 +87,14 @@ protected :
      */
     void on_receive(const boost::system::error_code &error, int size) ;
 
+    /**
+     * @brief handle_message
+     * Called for each message of a received datagram, see on_receive
+     * @param header : the header of the message
+     * @param body : the body of the message
+     */
+    void handle_message(const std::string& header, const std::string& body) ;
+
     /**
      * @brief check_ack
      * function called to check wether an ACK was recieved for a
@@ -20,6 +20,16 @@ public :
   std::string hostname ;
   std::string port ;
 
+  /**
+   * The number of snapshots of the NPCs sent to each client per second.
+   */
+  float snapshot_rate ;
+
+  /**
+   * The size up to which messages are packed in a datagram.
+   */
+  unsigned int mtu ;
+
   /**
    * @brief ServerInfo
    * Creates a new instace, using a default adress.
@@ -27,6 +37,8 @@ public :
   ServerInfo(){
      hostname = "localhost" ;
      port = "1234" ;
+     snapshot_rate = 10 ;
+     mtu = 1400 ;
   }
 } ;
 
@@ -0,0 +1,11 @@
+#include "snapshotAck.h"
+
+SnapshotAck::SnapshotAck() : player_id(0), sequence(-1) {
+}
+
+SnapshotAck::SnapshotAck(int player_id, int sequence) : player_id(player_id), sequence(sequence) {
+}
+
+SnapshotAck* SnapshotAck::copy() {
+  return new SnapshotAck(*this) ;
+}
@@ -0,0 +1,33 @@
+#ifndef SNAPSHOTACK_H
+#define SNAPSHOTACK_H
+
+#include "abstractMessage.h"
+
+/**
+ * @brief The SnapshotAck class : sent by a client when it has received all
+ * the parts of a snapshot (see GameUpdate), so that the server sends the next
+ * ones relative to it.
+ * It is sent unreliably : a lost ack only makes the next snapshots larger, and
+ * the client acknowledges every snapshot.
+ */
+class SnapshotAck : public AbstractMessage
+{
+public:
+  SnapshotAck() ;
+
+  /**
+   * @brief SnapshotAck
+   * @param player_id : the ID of the player of the client
+   * @param sequence : the number of the snapshot received
+   */
+  SnapshotAck(int player_id, int sequence) ;
+
+  SnapshotAck* copy() ;
+
+  int player_id ;
+  int sequence ;
+
+  SIMPLE_MESSAGE(SnapshotAck, AbstractMessage, player_id, sequence)
+};
+
+#endif // SNAPSHOTACK_H
@@ -1,32 +1,170 @@
 #include <assert.h>
+#include <algorithm>
+#include <cstdlib>
 
 #include "debug.h"
 #include "updateGenerator.h"
+#include "comunicatorImplem.h"
+#include "snapshotAck.h"
+#include "wireCodec.h"
 #include "simulation/globalState.h"
+#include "simulation/npc.h"
 #include "playerUpdate.h"
 
 /*
  * @author mheinric
  */
 
-UpdateGenerator::UpdateGenerator(GlobalState *globalState, Server* server) :
-  globalState(globalState), server(server), last_sent()
+constexpr float UpdateGenerator::DEFAULT_SNAPSHOT_RATE ;
+const int UpdateGenerator::HISTORY ;
+const int UpdateGenerator::INTEREST_RADIUS ;
+const int UpdateGenerator::INTEREST_HYSTERESIS ;
+
+UpdateGenerator::UpdateGenerator(GlobalState *globalState, Server* server, float snapshotRate) :
+  globalState(globalState), server(server), period(sf::seconds(1 / snapshotRate)), sequence(0), clients()
 {
 }
 
 
 void UpdateGenerator::update(sf::Time dt){
-  last_sent += dt ;
-  if(last_sent.asMilliseconds() > 1000.)
+  receiveAcks() ;
+  //snapshotRate snapshots par seconde, au rythme des ticks de la simulation
+  if(globalState->getScheduler().every(period))
     {
-      DBG << "Update Generator : sending update" ;
-      last_sent = sf::Time::Zero ;
-      for(int playerId : server->getConnectedPlayers())
+      TickProfiler::ScopedTimer timer(globalState->getProfiler(), TickProfiler::BROADCAST) ;
+      DBG << "Update Generator : sending snapshot " << sequence + 1 ;
+      sequence++ ;
+      //the NPCs seen by several clients are only read once
+      NpcStates states ;
+      std::vector<int> players = server->getConnectedPlayers() ;
+      for(int playerId : players)
+        sendSnapshot(playerId, states) ;
+
+      //forget the players who left
+      for(auto it = clients.begin() ; it != clients.end() ; )
         {
-          GameUpdate update = generateUpdate(globalState->getPlayerByID(playerId)) ;
-          server->sendMessage<GameUpdate>(update, playerId, false) ;
+          if(std::find(players.begin(), players.end(), it->first) == players.end())
+            it = clients.erase(it) ;
+          else
+            it++ ;
         }
     }
+  return ;
+}
+
+void UpdateGenerator::receiveAcks() {
+  std::vector<SnapshotAck*> acks = server->receiveMessages<SnapshotAck>() ;
+  for(SnapshotAck* ack : acks)
+    {
+      auto client = clients.find(ack->player_id) ;
+      if(client != clients.end() && ack->sequence > client->second.acked)
+        {
+          ClientSnapshots& snapshots = client->second ;
+          //the acks are unreliable : only the snapshots still kept can be a baseline
+          auto& sent = snapshots.sent ;
+          while(!sent.empty() && sent.front().first < ack->sequence)
+            sent.pop_front() ;
+          if(!sent.empty() && sent.front().first == ack->sequence)
+            snapshots.acked = ack->sequence ;
+        }
+      delete ack ;
+    }
+  return ;
+}
+
+std::shared_ptr<const NpcStates> UpdateGenerator::interestOf(Player& player, NpcStates& states,
+                                                             const NpcStates* last) {
+  std::shared_ptr<NpcStates> visible = std::make_shared<NpcStates>() ;
+  std::pair<int,int> center = player.getPosition().isInTile() ;
+  const int leave = INTEREST_RADIUS + INTEREST_HYSTERESIS ;
+  globalState->forEachNPCInDiamond(center.first, center.second, leave, [&](NPC* npc)
+    {
+      std::pair<int,int> tile = npc->getPosition().isInTile() ;
+      int d = std::abs(tile.first - center.first) + std::abs(tile.second - center.second) ;
+      boost::uuids::uuid id = npc->getUuid() ;
+      if(d <= INTEREST_RADIUS || (last != NULL && last->count(id) > 0))
+        {
+          auto state = states.find(id) ;
+          if(state == states.end())
+            state = states.insert(std::make_pair(id, NpcUpdate(*npc, true))).first ;
+          visible->insert(*state) ;
+        }
+    }) ;
+  return visible ;
+}
+
+void UpdateGenerator::sendSnapshot(int playerId, NpcStates& all) {
+  ClientSnapshots& snapshots = clients[playerId] ;
+  Player& player = globalState->getPlayerByID(playerId) ;
+  std::shared_ptr<const NpcStates> states =
+      interestOf(player, all, snapshots.sent.empty() ? NULL : snapshots.sent.back().second.get()) ;
+  const NpcStates* baseline = NULL ;
+  if(snapshots.acked >= 0 && !snapshots.sent.empty() && snapshots.sent.front().first == snapshots.acked)
+    baseline = snapshots.sent.front().second.get() ;
+
+  GameUpdate header = generateUpdate(player) ;
+  header.sequence = sequence ;
+  header.baseline = baseline == NULL ? -1 : snapshots.acked ;
+  //a part fills a datagram, with room for the sizes of the vectors growing by a byte or two
+  const size_t budget = server->getMtu() - ComunicatorImplem::HEADER_SIZE - ComunicatorImplem::LENGTH_SIZE - 8 ;
+
+  std::vector<GameUpdate> parts(1, header) ;
+  size_t used = header.encode(NULL, 0) ;
+  auto room = [&](size_t size)->GameUpdate&
+    {
+      if(used + size > budget)
+        {
+          parts.push_back(header) ;
+          used = header.encode(NULL, 0) ;
+        }
+      used += size ;
+      return parts.back() ;
+    } ;
+
+  for(const auto& entry : *states)
+    {
+      NpcUpdate update = entry.second ;
+      if(baseline != NULL)
+        {
+          auto before = baseline->find(entry.first) ;
+          if(before != baseline->end())
+            {
+              update.isCreated = false ;
+              update.fields = NpcUpdate::changes(before->second, entry.second) ;
+              if(update.fields == 0)
+                continue ;
+            }
+        }
+      WireWriter writer(NULL, 0) ;
+      writer << update ;
+      room(writer.size()).addNpcUpdate(update) ;
+    }
+  if(baseline != NULL)
+    {
+      for(const auto& entry : *baseline)
+        {
+          if(states->count(entry.first) == 0)
+            room(16).addRemoved(entry.first) ;
+        }
+    }
+
+  for(unsigned int i = 0 ; i < parts.size() ; i++)
+    {
+      parts[i].part = i ;
+      parts[i].parts = parts.size() ;
+      server->sendMessage<GameUpdate>(parts[i], playerId, false) ;
+    }
+  globalState->getProfiler().count(TickProfiler::MESSAGES_SENT, parts.size()) ;
+
+  snapshots.sent.push_back(std::make_pair(sequence, states)) ;
+  //the oldest one is the baseline : it goes when acks are lost for too long,
+  //the client gets whole snapshots until it acknowledges one again
+  if(snapshots.sent.size() > (size_t) HISTORY)
+    {
+      snapshots.sent.pop_front() ;
+      snapshots.acked = -1 ;
+    }
+  return ;
 }
 
 GameUpdate UpdateGenerator::generateUpdate(Player& player) {
@@ -34,19 +172,6 @@ GameUpdate UpdateGenerator::generateUpdate(Player& player) {
   GameUpdate update ;
   PlayerUpdate p_update(player);
   update.setPlayerUpdate(p_update);
-  /*
-  std::pair<int,int> tilePos = player.getPosition().isInTile() ;
-  if(!(tilePos.first >=0 && tilePos.first < globalState->getMap()->getMapWidth()))
-    DBG << "Player Outside the map" ;
-  if(!(tilePos.second >=0 && tilePos.second < globalState->getMap()->getMapWidth()))
-    DBG << "Player Outside the map" ;
-
-  for(int i = 0 ; i <  globalState->getMap()->getMapWidth() ; i++ )
-    {
-      for(int j = 0 ; j <  globalState->getMap()->getMapHeight() ; j++ )
-        addAllNpcs(update, globalState->getMap()->getTileRef(i,j));
-    }
-    */
   return update ;
 }
 
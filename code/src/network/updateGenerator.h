@@ -1,5 +1,8 @@
 #ifndef UPDATEGENERATOR_H
 #define UPDATEGENERATOR_H
+#include <deque>
+#include <map>
+#include <memory>
 #include "server.h"
 #include "gameUpdate.h"
 class GlobalState;
@@ -8,33 +11,85 @@ class Player ;
 /**
  * @brief The UpdateGenerator class : class used to generate updates on the Server side.
  * Call the update() method to send updates to all the clients.
+ *
+ * The NPCs are sent as snapshots, snapshotRate times a second : a snapshot
+ * to a client only carries the NPCs which appeared, changed or disappeared
+ * since the last snapshot the client has acknowledged (its baseline), and
+ * of these NPCs only the groups of fields which changed (see NpcUpdate).
+ * The states sent are kept until acknowledged, at most HISTORY of them ; a
+ * client which acknowledges nothing gets whole snapshots.
+ *
+ * A client only gets the NPCs around its player (its area of interest) : an
+ * NPC enters it within INTEREST_RADIUS tiles of the player, and leaves it
+ * beyond INTEREST_RADIUS + INTEREST_HYSTERESIS tiles, so that an NPC walking
+ * along the border is not sent again and again. An NPC entering the area is
+ * sent whole in the snapshot, as a creation, and one leaving it is in the
+ * removed NPCs of the snapshot.
  * @author mheinric
  */
 class UpdateGenerator
 {
 public:
 
+  /**
+   * @brief DEFAULT_SNAPSHOT_RATE : the number of snapshots per second by default
+   */
+  static constexpr float DEFAULT_SNAPSHOT_RATE = 10 ;
+
+  /**
+   * @brief HISTORY : the number of snapshots kept per client, waiting for an ack
+   */
+  static const int HISTORY = 32 ;
+
+  /**
+   * @brief INTEREST_RADIUS : the manhattan distance in tiles from the player under which
+   * the NPCs are sent to his client, a little more than the fog radius of the client (24)
+   */
+  static const int INTEREST_RADIUS = 28 ;
+
+  /**
+   * @brief INTEREST_HYSTERESIS : how much further an NPC sent must go before it is no longer sent
+   */
+  static const int INTEREST_HYSTERESIS = 8 ;
+
   /**
    * @brief UpdateGenerator : creates a new instance responsible of the synchronisation of the given global state, using the
    * given server as a mean of communication.
    * @param globalState : the global state that will be synced over the network
    * @param server : the server used for communication
+   * @param snapshotRate : the number of snapshots sent per second
    */
-  UpdateGenerator(GlobalState* globalState, Server* server);
+  UpdateGenerator(GlobalState* globalState, Server* server, float snapshotRate = DEFAULT_SNAPSHOT_RATE);
 
   /**
    * @brief update : A call to this method will generate the gameUpdates for all the Clients, and will
-   * send them over the network
+   * send them over the network, snapshotRate times a second of simulation ticks
    */
   void update(sf::Time dt) ;
 
 private :
   GlobalState* globalState ;
   Server* server ;
+
   /**
-   * @brief last_sent : last time the server broadcasted an update
+   * @brief period : the time between two snapshots
    */
-  sf::Time last_sent ;
+  sf::Time period ;
+
+  /**
+   * @brief sequence : the number of the last snapshot
+   */
+  int sequence ;
+
+  /**
+   * @brief The ClientSnapshots struct : the snapshots sent to a client
+   */
+  struct ClientSnapshots {
+    int acked = -1 ; // the last snapshot acknowledged
+    std::deque<std::pair<int, std::shared_ptr<const NpcStates> > > sent ;
+  };
+
+  std::map<int, ClientSnapshots> clients ;
 
   /**
    * @brief generateUpdate : generates the update to be sent to the given player
@@ -49,6 +104,29 @@ private :
    * @param tile
    */
   void addAllNpcs(GameUpdate& update, Tile& tile) ;
+
+  /**
+   * @brief receiveAcks : moves the baselines of the clients to the snapshots they acknowledged
+   */
+  void receiveAcks() ;
+
+  /**
+   * @brief interestOf : the NPCs in the area of interest of a player
+   * @param player : the player
+   * @param states : the states of the NPCs read for this snapshot so far, the
+   * NPCs of the area are added to it
+   * @param last : the NPCs sent in the last snapshot to the player, NULL if none
+   * @return the states of the NPCs in the area
+   */
+  std::shared_ptr<const NpcStates> interestOf(Player& player, NpcStates& states, const NpcStates* last) ;
+
+  /**
+   * @brief sendSnapshot : sends the current snapshot to a player, relative to his baseline,
+   * in as few datagrams as possible
+   * @param playerId : the player
+   * @param states : the states of the NPCs read for this snapshot so far, see interestOf
+   */
+  void sendSnapshot(int playerId, NpcStates& states) ;
 };
 
 #endif // UPDATEGENERATOR_H
@@ -0,0 +1,36 @@
+#include <map>
+#include <unordered_map>
+
+#include "wireCodec.h"
+
+
+/*
+ * The tables are built during static initialization, by the WIRE_TYPE
+ * objects : they are local statics so that they exist before the first one.
+ */
+static std::unordered_map<std::type_index, WireRegistry::Entry>& by_type() {
+  static std::unordered_map<std::type_index, WireRegistry::Entry> table ;
+  return table ;
+}
+
+static std::map<unsigned int, WireRegistry::Entry>& by_id() {
+  static std::map<unsigned int, WireRegistry::Entry> table ;
+  return table ;
+}
+
+void WireRegistry::add(std::type_index type, unsigned int id, Encoder encode, Decoder decode) {
+  assert(by_id().count(id) == 0) ;
+  Entry entry = {id, encode, decode} ;
+  by_type()[type] = entry ;
+  by_id()[id] = entry ;
+}
+
+const WireRegistry::Entry* WireRegistry::find(std::type_index type) {
+  auto it = by_type().find(type) ;
+  return it == by_type().end() ? NULL : &it->second ;
+}
+
+const WireRegistry::Entry* WireRegistry::find(unsigned int id) {
+  auto it = by_id().find(id) ;
+  return it == by_id().end() ? NULL : &it->second ;
+}
@@ -0,0 +1,338 @@
+#ifndef WIRECODEC_H
+#define WIRECODEC_H
+
+#include <boost/serialization/access.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <typeindex>
+#include <type_traits>
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "abstractMessage.h"
+
+/*
+ * Binary wire format of the messages.
+ *
+ * A message is its numeric type id (see WIRE_TYPE) followed by the fields
+ * listed in its serialize method (SIMPLE_MESSAGE, SIMPLE_SERIALIZATION...),
+ * in order, without any name nor separator :
+ *  - bool : 1 byte
+ *  - integers and enums : varint (7 bits per byte, little-endian, the high
+ *    bit set on every byte but the last), zigzag encoded if signed
+ *  - float, double : 4 or 8 bytes, IEEE 754, little-endian
+ *  - std::string, std::vector : varint size then the elements
+ *  - std::pair : its two values
+ *  - boost::uuids::uuid : its 16 bytes
+ *  - any other class : its own serialize method
+ * WireWriter and WireReader have the interface of the boost archives used by
+ * the serialize methods (operator&, <<, >>), so the same methods serve both.
+ */
+
+/**
+ * @brief The WireWriter class : writes values in the wire format into a
+ * buffer given by the caller.
+ * Writing past the end of the buffer only counts the bytes, so that the
+ * caller can find the size needed (see overflow).
+ */
+class WireWriter {
+public :
+  WireWriter(char* buffer, size_t capacity) : buffer(buffer), capacity(capacity), count(0) {}
+
+  /**
+   * @brief size : the number of bytes of the values written so far
+   */
+  size_t size() const { return count ; }
+
+  /**
+   * @brief overflow : true if the values did not fit in the buffer
+   */
+  bool overflow() const { return count > capacity ; }
+
+  template <class T>
+  WireWriter& operator&(const T& t) { save(t) ; return *this ; }
+
+  template <class T>
+  WireWriter& operator<<(const T& t) { save(t) ; return *this ; }
+
+  void write_varint(uint64_t v) {
+    while(v >= 0x80)
+      {
+        put((unsigned char) (v | 0x80)) ;
+        v >>= 7 ;
+      }
+    put((unsigned char) v) ;
+  }
+
+  void write_bytes(const void* data, size_t n) {
+    if(n > 0 && count + n <= capacity)
+      memcpy(buffer + count, data, n) ;
+    count += n ;
+  }
+
+  void save(bool b) { put(b ? 1 : 0) ; }
+  void save(float f) { uint32_t u ; memcpy(&u, &f, 4) ; write_fixed(u, 4) ; }
+  void save(double d) { uint64_t u ; memcpy(&u, &d, 8) ; write_fixed(u, 8) ; }
+  void save(const std::string& s) { write_varint(s.size()) ; write_bytes(s.data(), s.size()) ; }
+  void save(const boost::uuids::uuid& id) { write_bytes(id.data, 16) ; }
+
+  template <class T>
+  void save(const std::vector<T>& v) {
+    write_varint(v.size()) ;
+    for(const T& t : v)
+      save(t) ;
+  }
+
+  template <class T, class U>
+  void save(const std::pair<T,U>& p) {
+    save(p.first) ;
+    save(p.second) ;
+  }
+
+  template <class T>
+  void save(const T& t) {
+    save_value(t, std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value>()) ;
+  }
+
+private :
+  char* buffer ;
+  size_t capacity ;
+  size_t count ;
+
+  void put(unsigned char c) {
+    if(count < capacity)
+      buffer[count] = (char) c ;
+    count++ ;
+  }
+
+  void write_fixed(uint64_t u, int n) {
+    for(int i = 0 ; i < n ; i++)
+      put((unsigned char) (u >> (8*i))) ;
+  }
+
+  //integers and enums
+  template <class T>
+  void save_value(const T& t, std::true_type) {
+    if(std::is_signed<T>::value || std::is_enum<T>::value)
+      {
+        int64_t v = (int64_t) t ;
+        write_varint(((uint64_t) v << 1) ^ (uint64_t) (v >> 63)) ;
+      }
+    else
+      write_varint((uint64_t) t) ;
+  }
+
+  //classes
+  template <class T>
+  void save_value(const T& t, std::false_type) {
+    boost::serialization::access::serialize(*this, const_cast<T&>(t), 0) ;
+  }
+};
+
+
+/**
+ * @brief The WireReader class : reads values in the wire format from a buffer.
+ * Reading past the end of the buffer, or a size larger than what is left,
+ * makes the reader fail : the values read are then zero, see failed.
+ */
+class WireReader {
+public :
+  WireReader(const char* data, size_t size) : data(data), end(size), pos(0), error(false) {}
+
+  /**
+   * @brief failed : true if the buffer did not contain the values read
+   */
+  bool failed() const { return error ; }
+
+  /**
+   * @brief remaining : the number of bytes not read yet
+   */
+  size_t remaining() const { return end - pos ; }
+
+  template <class T>
+  WireReader& operator&(T& t) { load(t) ; return *this ; }
+
+  template <class T>
+  WireReader& operator>>(T& t) { load(t) ; return *this ; }
+
+  uint64_t read_varint() {
+    uint64_t v = 0 ;
+    for(int shift = 0 ; shift < 64 ; shift += 7)
+      {
+        unsigned char c = get() ;
+        v |= (uint64_t) (c & 0x7F) << shift ;
+        if(!(c & 0x80))
+          return v ;
+      }
+    error = true ;
+    return 0 ;
+  }
+
+  bool read_bytes(void* out, size_t n) {
+    if(error || n > end - pos)
+      {
+        error = true ;
+        return false ;
+      }
+    memcpy(out, data + pos, n) ;
+    pos += n ;
+    return true ;
+  }
+
+  void load(bool& b) { b = get() != 0 ; }
+  void load(float& f) { uint32_t u = (uint32_t) read_fixed(4) ; memcpy(&f, &u, 4) ; }
+  void load(double& d) { uint64_t u = read_fixed(8) ; memcpy(&d, &u, 8) ; }
+
+  void load(std::string& s) {
+    uint64_t n = read_varint() ;
+    if(error || n > end - pos)
+      {
+        error = true ;
+        s.clear() ;
+        return ;
+      }
+    s.assign(data + pos, n) ;
+    pos += n ;
+  }
+
+  void load(boost::uuids::uuid& id) {
+    if(!read_bytes(id.data, 16))
+      memset(id.data, 0, 16) ;
+  }
+
+  template <class T>
+  void load(std::vector<T>& v) {
+    uint64_t n = read_varint() ;
+    v.clear() ;
+    //every element takes at least one byte
+    if(error || n > end - pos)
+      {
+        error = true ;
+        return ;
+      }
+    v.resize(n) ;
+    for(T& t : v)
+      load(t) ;
+  }
+
+  template <class T, class U>
+  void load(std::pair<T,U>& p) {
+    load(p.first) ;
+    load(p.second) ;
+  }
+
+  template <class T>
+  void load(T& t) {
+    load_value(t, std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value>()) ;
+  }
+
+private :
+  const char* data ;
+  size_t end ;
+  size_t pos ;
+  bool error ;
+
+  unsigned char get() {
+    if(error || pos >= end)
+      {
+        error = true ;
+        return 0 ;
+      }
+    return (unsigned char) data[pos++] ;
+  }
+
+  uint64_t read_fixed(int n) {
+    uint64_t u = 0 ;
+    for(int i = 0 ; i < n ; i++)
+      u |= (uint64_t) get() << (8*i) ;
+    return u ;
+  }
+
+  //integers and enums
+  template <class T>
+  void load_value(T& t, std::true_type) {
+    uint64_t u = read_varint() ;
+    if(std::is_signed<T>::value || std::is_enum<T>::value)
+      t = (T) (int64_t) ((u >> 1) ^ (~(u & 1) + 1)) ;
+    else
+      t = (T) u ;
+  }
+
+  //classes
+  template <class T>
+  void load_value(T& t, std::false_type) {
+    boost::serialization::access::serialize(*this, t, 0) ;
+  }
+};
+
+
+/**
+ * @brief The WireRegistry class : the numeric type ids of the message classes,
+ * and how to write and read each of them.
+ * Classes are registered once, with WIRE_TYPE, next to their BOOST_CLASS_EXPORT
+ * (see abstractMessage.cc).
+ */
+class WireRegistry {
+public :
+  typedef void (*Encoder)(const AbstractMessage&, WireWriter&) ;
+  typedef AbstractMessage* (*Decoder)(WireReader&) ;
+
+  struct Entry {
+    unsigned int id ;
+    Encoder encode ;
+    Decoder decode ;
+  };
+
+  /**
+   * @brief add : registers a class. Two classes must not have the same id.
+   */
+  static void add(std::type_index type, unsigned int id, Encoder encode, Decoder decode) ;
+
+  /**
+   * @brief find : the entry of a class
+   * @return NULL if the class was not registered
+   */
+  static const Entry* find(std::type_index type) ;
+
+  /**
+   * @brief find : the entry of a type id
+   * @return NULL if no class has this id
+   */
+  static const Entry* find(unsigned int id) ;
+};
+
+
+/**
+ * @brief The WireType class : registers a message class on construction, see WIRE_TYPE
+ */
+template <class MsgType>
+class WireType {
+public :
+  WireType(unsigned int id) {
+    WireRegistry::add(std::type_index(typeid(MsgType)), id, &encode, &decode) ;
+  }
+
+  static void encode(const AbstractMessage& msg, WireWriter& writer) {
+    writer << static_cast<const MsgType&>(msg) ;
+  }
+
+  static AbstractMessage* decode(WireReader& reader) {
+    //as boost does, so that private default constructors can be used
+    MsgType* msg = static_cast<MsgType*>(::operator new(sizeof(MsgType))) ;
+    boost::serialization::access::construct(msg) ;
+    reader >> *msg ;
+    return msg ;
+  }
+};
+
+/**
+ * Gives the message class ClassName the type id id (an integer literal, small
+ * ids take one byte on the wire). Use it in a .cc file, once per class.
+ */
+#define WIRE_TYPE(ClassName, id) \
+  static WireType<ClassName> wire_type_##id(id) ;
+
+#endif // WIRECODEC_H
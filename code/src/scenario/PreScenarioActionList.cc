@@ -9,6 +9,7 @@
 #include "ActionsTerro.h"
 #include "geography.h"
 #include "../simulation/npc.h"
+#include <cstdlib>
 
 /*****************
  *ChangeDirection*
@@ -306,6 +307,12 @@ void RemoveNPC::run () {
  *********************************************************/
 
 
+/* réglages de l'anxiété (sur 100) ajoutée là où ça se passe, qui se diffuse
+ * ensuite et marque les tiles à relaxer, voir Simulation::raiseAnxiety */
+static const float KILL_ANXIETY = 20; // un meurtre : les voisins s'inquiètent
+static const float EXPLOSION_ANXIETY = 10; // par unité de puissance, 10 de puissance suffisent pour 100
+static const int EXPLOSION_RUBBLE = 4; // puissance par tile de rayon couverte de gravats
+
 void KillNPC(boost::uuids::uuid target, Simulation* s ){
 	boost::uuids::uuid t = target;
 	NPC* victim = s->getNPCByID(t);
@@ -314,6 +321,8 @@ void KillNPC(boost::uuids::uuid target, Simulation* s ){
 	}
 	else {
 		victim->kill();
+		std::pair<int,int> tile = victim->getPosition().isInTile();
+		s->raiseAnxiety(tile.first, tile.second, KILL_ANXIETY);
 	};
 	std::cout << "YOU BASTARD !!!" << std::endl;
 	return;
@@ -326,14 +335,25 @@ void DropItem (int stuffID, int playerID, Simulation* simulation){
 
 
 void Explosion (int power, std::pair<int,int> location,Simulation* simulation) {
-	std::list<Tile*>* nb = simulation->getMap()->neighbors(power, simulation->getMap()->getTile(location));
 	std::cout << "nobody : ça explose!!!!!" << std::endl;
-	for (std::list<Tile*>::iterator t = nb->begin(); t != nb->end();++t) {
-		std::list<NPC*> npcs = (*t)->getNPCs();
-		for(std::list<NPC*>::iterator n = npcs.begin(); n != npcs.end(); ++n){
-			(*n)->kill();
+	// toutes les cases à distance (manhattan) au plus power
+	simulation->forEachNPCInDiamond(location.first, location.second, power, [](NPC* n) {
+		n->kill();
+	});
+	simulation->raiseAnxiety(location.first, location.second, power * EXPLOSION_ANXIETY);
+	// les gravats bloquent les tiles autour : seuls les chemins qui y passent sont refaits
+	int radius = power / EXPLOSION_RUBBLE;
+	std::vector<std::pair<int,int> > rubble;
+	for (int i = location.first - radius; i <= location.first + radius; i++) {
+		for (int j = location.second - radius; j <= location.second + radius; j++) {
+			if (std::abs(i - location.first) + std::abs(j - location.second) <= radius
+			    && simulation->getMap()->isInTheMap(i, j)) {
+				simulation->getMap()->getTile(i, j)->setDestructionLevel(1);
+				rubble.push_back(std::make_pair(i, j));
+			}
 		}
-	};
+	}
+	simulation->setBlocked(rubble, true);
 	std::cout << "nobody : fin d'explosion!!!!!"<< std::endl ;
 };
 
@@ -0,0 +1,254 @@
+#include "anxietyField.h"
+#include "threadPool.h"
+#include "../generation/geography.h"
+#include "../generation/tile.h"
+#include <algorithm>
+#include <cmath>
+#if defined(__AVX__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* au-delà, le schéma explicite oscille : on découpe le pas */
+static const float MAX_ALPHA = 0.25f;
+/* nombre de cases par tâche du ThreadPool */
+static const int CELLS_PER_BAND = 4096;
+
+
+void AnxietyField::reset(int width,int height) {
+  this->width = width;
+  this->height = height;
+  cells.assign(width*height, 0);
+  next.assign(width*height, 0);
+  state.assign(width*height, 0);
+  active.clear();
+  nextActive.clear();
+  changed.clear();
+  allChanged = true;
+  return;
+}
+
+
+void AnxietyField::load(Geography& map) {
+  reset(map.getMapWidth(), map.getMapHeight());
+  for (int i = 0; i < width; i++) {
+    for (int j = 0; j < height; j++) {
+      cells[i*height+j] = map.getTile(i,j)->getAnxiety();
+    }
+  }
+  //rien ne dit que la carte générée est à l'équilibre
+  for (int k = 0; k < width*height; k++) {
+    activate(k, active);
+  }
+  allChanged = false;
+  return;
+}
+
+
+void AnxietyField::store(Geography& map) {
+  if (allChanged) {
+    for (int i = 0; i < width; i++) {
+      for (int j = 0; j < height; j++) {
+        map.getTile(i,j)->setAnxiety(cells[i*height+j]);
+      }
+    }
+  } else {
+    for (int k : changed) {
+      map.getTile(k / height, k % height)->setAnxiety(cells[k]);
+    }
+  }
+  for (int k : changed) {
+    state[k] &= ~CHANGED;
+  }
+  changed.clear();
+  allChanged = false;
+  return;
+}
+
+
+void AnxietyField::set(int i,int j,float anxiety) {
+  cells[i*height+j] = anxiety;
+  markDirty(i,j);
+  return;
+}
+
+
+void AnxietyField::markDirty(int i,int j) {
+  int k = i*height+j;
+  touch(k);
+  activateWithNeighbours(k, active);
+  return;
+}
+
+
+void AnxietyField::setMode(Mode m) {
+  if (m == SPARSE && mode == FULL) {
+    //on ne sait pas ce qui a bougé : tout le monde repart
+    for (int k = 0; k < width*height; k++) {
+      activate(k, active);
+    }
+  }
+  mode = m;
+  return;
+}
+
+
+void AnxietyField::activate(int k,std::vector<int>& list) {
+  if (!(state[k] & ACTIVE)) {
+    state[k] |= ACTIVE;
+    list.push_back(k);
+  }
+  return;
+}
+
+
+void AnxietyField::activateWithNeighbours(int k,std::vector<int>& list) {
+  int i = k / height, j = k % height;
+  activate(k, list);
+  if (i > 0) activate(k-height, list);
+  if (i < width-1) activate(k+height, list);
+  if (j > 0) activate(k-1, list);
+  if (j < height-1) activate(k+1, list);
+  return;
+}
+
+
+void AnxietyField::touch(int k) {
+  if (!(state[k] & CHANGED)) {
+    state[k] |= CHANGED;
+    changed.push_back(k);
+  }
+  return;
+}
+
+
+void AnxietyField::diffuse(float dt,ThreadPool& pool) {
+  if (width == 0 || height == 0 || dt <= 0) {
+    return;
+  }
+  float alpha = RATE * dt;
+  int steps = (int) std::ceil(alpha / MAX_ALPHA);
+  alpha = alpha / steps;
+  float threshold = EPSILON * dt / steps;
+  for (int s = 0; s < steps; s++) {
+    if (mode == SPARSE && active.empty()) {
+      return;
+    }
+    //au-delà d'un quart de la carte, parcourir la liste coûte plus que tout calculer
+    if (mode == SPARSE && (int) active.size() < width*height / 4) {
+      diffuseSparse(alpha, threshold);
+    } else {
+      diffuseDense(alpha, threshold, pool);
+    }
+  }
+  return;
+}
+
+
+void AnxietyField::diffuseDense(float alpha,float threshold,ThreadPool& pool) {
+  int band = std::max(1, CELLS_PER_BAND / height);
+  pool.parallelFor(0, width, band, [this,alpha](int first, int last) {
+    diffuseRows(first, last, alpha);
+  });
+  allChanged = true;
+  if (mode == SPARSE) {
+    for (int k : active) {
+      state[k] &= ~ACTIVE;
+    }
+    active.clear();
+    for (int k = 0; k < width*height; k++) {
+      if (std::fabs(next[k] - cells[k]) >= threshold) {
+        activateWithNeighbours(k, active);
+      }
+    }
+  }
+  cells.swap(next);
+  return;
+}
+
+
+void AnxietyField::diffuseSparse(float alpha,float threshold) {
+  //on calcule toutes les cases actives avant d'en modifier une
+  for (int k : active) {
+    next[k] = relaxCell(k, alpha);
+  }
+  for (int k : active) {
+    state[k] &= ~ACTIVE;
+  }
+  nextActive.clear();
+  for (int k : active) {
+    if (std::fabs(next[k] - cells[k]) >= threshold) {
+      activateWithNeighbours(k, nextActive);
+    }
+    if (next[k] != cells[k]) {
+      cells[k] = next[k];
+      touch(k);
+    }
+  }
+  active.swap(nextActive);
+  return;
+}
+
+
+/**
+ * @brief one cell of the stencil, the missing neighbours being the cell itself
+ */
+static inline float relax(float c,float up,float down,float left,float right,float alpha) {
+  return c + alpha * (((up + down) + (left + right)) - 4*c);
+}
+
+
+float AnxietyField::relaxCell(int k,float alpha) const {
+  int i = k / height, j = k % height;
+  float c = cells[k];
+  return relax(c,
+               i > 0 ? cells[k-height] : c,
+               i < width-1 ? cells[k+height] : c,
+               j > 0 ? cells[k-1] : c,
+               j < height-1 ? cells[k+1] : c,
+               alpha);
+}
+
+
+void AnxietyField::diffuseRows(int first,int last,float alpha) {
+  for (int i = first; i < last; i++) {
+    const float* c = &cells[i*height];
+    const float* up = i > 0 ? c - height : c;
+    const float* down = i < width-1 ? c + height : c;
+    float* out = &next[i*height];
+
+    if (height == 1) {
+      out[0] = relax(c[0], up[0], down[0], c[0], c[0], alpha);
+      continue;
+    }
+    out[0] = relax(c[0], up[0], down[0], c[0], c[1], alpha);
+    out[height-1] = relax(c[height-1], up[height-1], down[height-1], c[height-2], c[height-1], alpha);
+
+    //intérieur de la ligne
+    int j = 1;
+#if defined(__AVX__)
+    const __m256 a8 = _mm256_set1_ps(alpha);
+    const __m256 four8 = _mm256_set1_ps(4.f);
+    for (; j + 8 <= height-1; j += 8) {
+      __m256 center = _mm256_loadu_ps(c+j);
+      __m256 sum = _mm256_add_ps(_mm256_add_ps(_mm256_loadu_ps(up+j), _mm256_loadu_ps(down+j)),
+                                 _mm256_add_ps(_mm256_loadu_ps(c+j-1), _mm256_loadu_ps(c+j+1)));
+      sum = _mm256_sub_ps(sum, _mm256_mul_ps(four8, center));
+      _mm256_storeu_ps(out+j, _mm256_add_ps(center, _mm256_mul_ps(a8, sum)));
+    }
+#elif defined(__SSE2__)
+    const __m128 a4 = _mm_set1_ps(alpha);
+    const __m128 four4 = _mm_set1_ps(4.f);
+    for (; j + 4 <= height-1; j += 4) {
+      __m128 center = _mm_loadu_ps(c+j);
+      __m128 sum = _mm_add_ps(_mm_add_ps(_mm_loadu_ps(up+j), _mm_loadu_ps(down+j)),
+                              _mm_add_ps(_mm_loadu_ps(c+j-1), _mm_loadu_ps(c+j+1)));
+      sum = _mm_sub_ps(sum, _mm_mul_ps(four4, center));
+      _mm_storeu_ps(out+j, _mm_add_ps(center, _mm_mul_ps(a4, sum)));
+    }
+#endif
+    for (; j < height-1; j++) {
+      out[j] = relax(c[j], up[j], down[j], c[j-1], c[j+1], alpha);
+    }
+  }
+  return;
+}
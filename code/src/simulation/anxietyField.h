@@ -0,0 +1,157 @@
+#ifndef ANXIETY_FIELD_H
+#define ANXIETY_FIELD_H
+
+#include <vector>
+
+class Geography;
+class ThreadPool;
+
+/**
+ * @brief The AnxietyField class
+ * the anxiety of every tile of the map, as a contiguous grid of floats
+ * (cell (i,j) at i*height+j), and its diffusion.
+ *
+ * A diffusion step relaxes each tile towards its four neighbours :
+ *   a'(i,j) = a(i,j) + alpha * (sum of the neighbours - 4*a(i,j))
+ * with alpha = RATE*dt. For dt = 1 second this is the former
+ * (5*a + neighbours)/9 of Simulation::lisserMatrice. Borders don't leak :
+ * a missing neighbour counts as the tile itself, so the total anxiety of
+ * the map is kept.
+ * The step reads the grid and writes a second one before swapping them, so
+ * the rows can be computed in parallel.
+ *
+ * In SPARSE mode (the default) only the active tiles are relaxed. Writing a
+ * tile activates it with its neighbours ; a tile whose anxiety changes by
+ * more than EPSILON per second activates its neighbours for the next step,
+ * and retires otherwise. The active region thus spreads from the events and
+ * vanishes once the anxiety has settled, so a quiet map costs almost
+ * nothing. When most of the map is active, a dense step is used instead.
+ */
+class AnxietyField {
+ public:
+  /**
+   * @brief RATE : the diffusion speed, per second
+   */
+  static constexpr float RATE = 1/9.f;
+
+  /**
+   * @brief EPSILON : below this change per second, a tile retires
+   */
+  static constexpr float EPSILON = 0.01f;
+
+  enum Mode {
+    FULL,   // every tile at every step
+    SPARSE  // only the tiles around recent changes
+  };
+
+  /**
+   * @brief reset
+   * makes the field a width x height grid of zeros
+   */
+  void reset(int width,int height);
+
+  /**
+   * @brief load
+   * resizes the field to the map and copies the anxiety of its tiles, which
+   * are all active until they have settled
+   */
+  void load(Geography& map);
+
+  /**
+   * @brief store
+   * copies the tiles changed since the last call back to the map, which the
+   * tiles are drawn from
+   */
+  void store(Geography& map);
+
+  float get(int i,int j) const {
+    return cells[i*height+j];
+  }
+
+  /**
+   * @brief set
+   * sets the anxiety of a tile and marks it dirty
+   */
+  void set(int i,int j,float anxiety);
+
+  /**
+   * @brief markDirty
+   * activates the tile (i,j) and its neighbours, to be called when the
+   * anxiety of the tile has changed
+   */
+  void markDirty(int i,int j);
+
+  int getWidth() const {
+    return width;
+  }
+
+  int getHeight() const {
+    return height;
+  }
+
+  void setMode(Mode m);
+
+  Mode getMode() const {
+    return mode;
+  }
+
+  /**
+   * @brief getActiveCount
+   * @return the number of tiles relaxed at the next sparse step
+   */
+  int getActiveCount() const {
+    return (int) active.size();
+  }
+
+  /**
+   * @brief diffuse
+   * lets the anxiety spread for dt seconds, in several steps if dt is too
+   * large for one step to stay stable
+   * @param dt : the time, in seconds
+   * @param pool : the threads among which the rows are shared
+   */
+  void diffuse(float dt,ThreadPool& pool);
+
+ private:
+  /* bits of state */
+  static const unsigned char ACTIVE = 1;
+  static const unsigned char CHANGED = 2;
+
+  int width = 0;
+  int height = 0;
+  Mode mode = SPARSE;
+  std::vector<float> cells;
+  std::vector<float> next;
+
+  std::vector<unsigned char> state;
+  std::vector<int> active;      // the ACTIVE cells
+  std::vector<int> nextActive;
+  std::vector<int> changed;     // the CHANGED cells, to store
+  bool allChanged = false;
+
+  /**
+   * @brief diffuseRows
+   * computes the rows [first,last[ of the next grid, see diffuse
+   */
+  void diffuseRows(int first,int last,float alpha);
+
+  /**
+   * @brief diffuseSparse
+   * one step over the active cells only
+   */
+  void diffuseSparse(float alpha,float threshold);
+
+  /**
+   * @brief diffuseDense
+   * one step over the whole grid, and the active cells it leaves if the
+   * field is in SPARSE mode
+   */
+  void diffuseDense(float alpha,float threshold,ThreadPool& pool);
+
+  float relaxCell(int k,float alpha) const;
+  void activate(int k,std::vector<int>& list);
+  void activateWithNeighbours(int k,std::vector<int>& list);
+  void touch(int k);
+};
+
+#endif // ANXIETY_FIELD_H
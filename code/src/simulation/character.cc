@@ -50,16 +50,33 @@ bool Character::hasArrived() {
 
 float Character::potential(Position p) {
   std::pair<float,float> speedVect = trajectory.getSpeed();
-  float speed = sqrt(pow(speedVect.first,2)+pow(speedVect.second,2));
-  Position pDeltaT = getPosition();//position à t+deltaT 
-  pDeltaT.add(deltaT * speedVect.first,deltaT*speedVect.second);
+  Position& position = getPosition();
+  return potential(p.getX(),p.getY(),position.getX(),position.getY(),
+                   speedVect.first,speedVect.second,deltaT,lambda,Vzero);
+}
+
+
+std::pair<float,float> Character::gradPot(Position p) {
+  std::pair<float,float> speedVect = trajectory.getSpeed();
+  Position& position = getPosition();
+  return gradPot(p.getX(),p.getY(),position.getX(),position.getY(),
+                 speedVect.first,speedVect.second,deltaT,lambda,Vzero);
+}
+
+
+float Character::potential(float px,float py,float x,float y,float vx,float vy,
+                           float deltaT,float lambda,float Vzero) {
+  float speed = sqrt(vx*vx+vy*vy);
+  //position à t+deltaT
+  float xDeltaT = x + deltaT*vx;
+  float yDeltaT = y + deltaT*vy;
   /* a, b et c pour l'ellipse de foyers position et pDeltaT
      et où p se trouve*/
   float a, b, c;
-  a = 0.5 * (p.distance(getPosition()) + p.distance(pDeltaT));
+  a = 0.5 * (sqrt((px-x)*(px-x)+(py-y)*(py-y)) + sqrt((px-xDeltaT)*(px-xDeltaT)+(py-yDeltaT)*(py-yDeltaT)));
   c = 0.5 * speed * deltaT;
   if (a>c) {
-    b = sqrt(pow(a,2)-pow(c,2));
+    b = sqrt(a*a-c*c);
   } else {
     b=0;
   }
@@ -67,15 +84,12 @@ float Character::potential(Position p) {
 }
 
 
-std::pair<float,float> Character::gradPot(Position p) {
-  p.add(0.01,0);
-  float potdx = potential(p);
-  p.add(-0.02,0);
-  float potmdx = potential(p);
-  p.add(0.01,0.01);
-  float potdy = potential(p);
-  p.add(0,-0.02);
-  float potmdy = potential(p);
+std::pair<float,float> Character::gradPot(float px,float py,float x,float y,float vx,float vy,
+                                          float deltaT,float lambda,float Vzero) {
+  float potdx = potential(px+0.01,py,x,y,vx,vy,deltaT,lambda,Vzero);
+  float potmdx = potential(px-0.01,py,x,y,vx,vy,deltaT,lambda,Vzero);
+  float potdy = potential(px,py+0.01,x,y,vx,vy,deltaT,lambda,Vzero);
+  float potmdy = potential(px,py-0.01,x,y,vx,vy,deltaT,lambda,Vzero);
   std::pair<float,float> grad ((potdx-potmdx)/0.02,(potdy-potmdy)/0.02);
   return grad;
 }
@@ -74,15 +74,6 @@ class Character : public Positionable {
    */
   void setSpeed(float s);
 
-  /**
-   * @brief updatePosition
-   * updates the Character's position
-   * ie tells him to move towards his target for a small time interval
-   * @param dt : the time interval during which the Character will move
-   * @param map : the map on which the Character moves
-   */
-  virtual void updatePosition(sf::Time dt,Geography& map) = 0;
-
   /**
    * @brief potential
    * computes the potential created by the Character
@@ -97,6 +88,24 @@ class Character : public Positionable {
    */
   std::pair<float,float> gradPot(Position p);
 
+  /**
+   * @brief potential
+   * computes at (px,py) the potential created by a Character in (x,y) with
+   * speed (vx,vy) and parameters deltaT, lambda and Vzero
+   * It is the ellipse-shaped potential described in Helbing and Molnár,
+   * "Social force model for pedestrian dynamics".
+   */
+  static float potential(float px,float py,float x,float y,float vx,float vy,
+                         float deltaT,float lambda,float Vzero);
+
+  /**
+   * @brief gradPot
+   * computes at (px,py) the gradient of the potential created by a
+   * Character in (x,y), see the static potential
+   */
+  static std::pair<float,float> gradPot(float px,float py,float x,float y,float vx,float vy,
+                                        float deltaT,float lambda,float Vzero);
+
   /**
    * @brief getTarget
    * @return the Character's target position
@@ -7,6 +7,7 @@
 #include "withUuid.h"
 #include "eventManager.h"
 #include <type_traits>
+#include <iostream>
 #include <boost/uuid/uuid_io.hpp>
 
 /**
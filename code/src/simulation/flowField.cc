@@ -0,0 +1,130 @@
+#include "flowField.h"
+#include "../generation/navGrid.h"
+#include <algorithm>
+#include <utility>
+
+
+const int FlowField::UNKNOWN;
+
+
+FlowField::FlowField(const NavGrid& grid,const std::vector<int>& g) : goals(g) {
+  width = grid.getWidth();
+  height = grid.getHeight();
+  next.assign(grid.getSize(), -1);
+  distance.assign(grid.getSize(), UNKNOWN);
+  goalOf.assign(grid.getSize(), -1);
+  for (int goal : goals) {
+    if (!grid.isBlocked(goal)) {
+      distance[goal] = 0;
+      goalOf[goal] = goal;
+      open.push_back(std::make_pair(0, goal));
+    }
+  }
+  //toutes les distances de départ sont nulles : le tas est déjà ordonné
+  spread(grid);
+  return;
+}
+
+
+int FlowField::sources(const NavGrid& grid,int x,int out[4]) const {
+  int i = grid.getAbs(x), j = grid.getOrd(x);
+  int n = 0;
+  if (j < height-1 && (grid.getMoves(x+1) & NavGrid::DOWN)) out[n++] = x+1;
+  if (i < width-1 && (grid.getMoves(x+height) & NavGrid::LEFT)) out[n++] = x+height;
+  if (i > 0 && (grid.getMoves(x-height) & NavGrid::RIGHT)) out[n++] = x-height;
+  if (j > 0 && (grid.getMoves(x-1) & NavGrid::UP)) out[n++] = x-1;
+  return n;
+}
+
+
+void FlowField::spread(const NavGrid& grid) {
+  int from[4];
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end());
+    int d = -open.back().first;
+    int x = open.back().second;
+    open.pop_back();
+    if (d > distance[x]) {
+      continue;
+    }
+    int n = sources(grid, x, from);
+    for (int k = 0; k < n; k++) {
+      int y = from[k];
+      if (d+1 < distance[y]) {
+        distance[y] = d+1;
+        next[y] = x;
+        goalOf[y] = goalOf[x];
+        open.push_back(std::make_pair(-(d+1), y));
+        std::push_heap(open.begin(), open.end());
+      }
+    }
+  }
+  return;
+}
+
+
+int FlowField::refresh(const NavGrid& grid,const std::vector<int>& changed) {
+  //les tiles dont le chemin passait par une tile bloquée : le sous-arbre de
+  //celle-ci, en remontant next
+  std::vector<int> lost;
+  for (int c : changed) {
+    if (grid.isBlocked(c) && distance[c] != UNKNOWN) {
+      distance[c] = UNKNOWN;
+      lost.push_back(c);
+    }
+  }
+  for (size_t q = 0; q < lost.size(); q++) {
+    int x = lost[q];
+    int i = grid.getAbs(x), j = grid.getOrd(x);
+    int around[4];
+    int n = 0;
+    if (j < height-1) around[n++] = x+1;
+    if (i < width-1) around[n++] = x+height;
+    if (i > 0) around[n++] = x-height;
+    if (j > 0) around[n++] = x-1;
+    for (int k = 0; k < n; k++) {
+      int y = around[k];
+      if (next[y] == x && distance[y] != UNKNOWN) {
+        distance[y] = UNKNOWN;
+        lost.push_back(y);
+      }
+    }
+    next[x] = -1;
+    goalOf[x] = -1;
+  }
+
+  //elles repartent de leurs voisines intactes, les tiles débloquées aussi
+  std::vector<int> seeds(lost);
+  for (int c : changed) {
+    if (!grid.isBlocked(c)) {
+      seeds.push_back(c);
+    }
+  }
+  int to[4];
+  for (int y : seeds) {
+    if (grid.isBlocked(y)) {
+      continue;
+    }
+    if (std::binary_search(goals.begin(), goals.end(), y)) {
+      distance[y] = 0;
+      next[y] = -1;
+      goalOf[y] = y;
+    } else {
+      int n = grid.getNeighbours(y, to);
+      for (int k = 0; k < n; k++) {
+        int z = to[k];
+        if (distance[z] != UNKNOWN && distance[z]+1 < distance[y]) {
+          distance[y] = distance[z]+1;
+          next[y] = z;
+          goalOf[y] = goalOf[z];
+        }
+      }
+    }
+    if (distance[y] != UNKNOWN) {
+      open.push_back(std::make_pair(-distance[y], y));
+      std::push_heap(open.begin(), open.end());
+    }
+  }
+  spread(grid);
+  return (int) lost.size();
+}
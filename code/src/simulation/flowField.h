@@ -0,0 +1,110 @@
+#ifndef FLOW_FIELD_H
+#define FLOW_FIELD_H
+
+#include <vector>
+#include <utility>
+
+class NavGrid;
+
+/**
+ * @brief The FlowField class
+ * the way from every tile of a map to the nearest of a set of goal tiles
+ * (the exits of the map, a bank...), computed by one breadth first search
+ * backwards from all the goals at once : for every tile, the next tile to
+ * go to, the distance left and the goal reached.
+ * Any number of NPCs can then head for the goals with one lookup per tile,
+ * without a search of their own (see Trajectory::followField).
+ * When tiles are blocked or unblocked, only the tiles whose way changes are
+ * computed again, see refresh. The fields of a map are kept by the
+ * Geography, see Geography::getFlowField.
+ */
+class FlowField {
+ public:
+  /**
+   * @brief FlowField
+   * computes the way to the goals from every tile of the grid
+   * @param grid : the moves allowed
+   * @param goals : the ids of the goal tiles, sorted, without duplicates
+   */
+  FlowField(const NavGrid& grid,const std::vector<int>& goals);
+
+  const std::vector<int>& getGoals() const {
+    return goals;
+  }
+
+  int getId(int i,int j) const {
+    return i*height+j;
+  }
+
+  int getAbs(int id) const {
+    return id / height;
+  }
+
+  int getOrd(int id) const {
+    return id % height;
+  }
+
+  /**
+   * @brief getNext
+   * @return the id of the tile to go to from the tile id, -1 if it is a goal
+   * or no goal can be reached from it
+   */
+  int getNext(int id) const {
+    return next[id];
+  }
+
+  /**
+   * @brief getDistance
+   * @return the number of moves from the tile id to the nearest goal,
+   * UNKNOWN if no goal can be reached
+   */
+  int getDistance(int id) const {
+    return distance[id];
+  }
+
+  /**
+   * @brief getGoal
+   * @return the goal reached by following the field from the tile id, -1 if
+   * there is none
+   */
+  int getGoal(int id) const {
+    return goalOf[id];
+  }
+
+  /**
+   * @brief refresh
+   * updates the field once tiles have been blocked or unblocked in the grid :
+   * the tiles whose way went through a newly blocked tile are computed again
+   * from their neighbours, and the shorter ways opened by unblocked tiles are
+   * spread, the rest of the field is kept
+   * @param changed : the ids of the tiles which changed
+   * @return the number of tiles whose way was computed again
+   */
+  int refresh(const NavGrid& grid,const std::vector<int>& changed);
+
+  static const int UNKNOWN = 0x7FFFFFFF;
+
+ private:
+  int width;
+  int height;
+  std::vector<int> goals;
+  std::vector<int> next;
+  std::vector<int> distance;
+  std::vector<int> goalOf;
+  std::vector<std::pair<int,int>> open; // tas de (-distance, tile)
+
+  /**
+   * @brief sources
+   * writes the ids of the tiles from which one move leads to x
+   * @return the number of ids written
+   */
+  int sources(const NavGrid& grid,int x,int out[4]) const;
+
+  /**
+   * @brief spread
+   * Dijkstra backwards from the tiles of open
+   */
+  void spread(const NavGrid& grid);
+};
+
+#endif // FLOW_FIELD_H
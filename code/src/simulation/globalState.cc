@@ -24,6 +24,22 @@ void GlobalState::setServer(Server *_server) {
 }
 
 void GlobalState::run(sf::Time dt) {
+	scheduler.startTick();
+	{
+		TickProfiler::ScopedTimer timer(profiler, TickProfiler::TICK);
+		runActions();
+		runDiffusion(dt);
+		runMovement(dt);
+		runUpdates(dt);
+	}
+	profiler.endTick(scheduler);
+	return;
+}
+
+void GlobalState::runActions() {
+	/*les tâches périodiques se règlent sur le compteur de ticks*/
+	bool newSecond = scheduler.every(sf::seconds(1));
+
 	//If their is not enough money, remove an agent and a camera
 	if (mesSous < 0) {
 		if (!(this->agents.empty())) {
@@ -34,6 +50,8 @@ void GlobalState::run(sf::Time dt) {
 		}
 	}
 
+	{
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::NETWORK);
 	/**The server retrieve all the new messages from the network (of type Action),
 	 *turn them into ScenarioAction, and add those ScenarioAction to the list of
 	 *pending ScenarioAction
@@ -78,7 +96,9 @@ void GlobalState::run(sf::Time dt) {
 	}
 
 	mouseMovFromNetwork.clear();
+	}
 
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::ACTIONS);
 	for (ScenarioAction* action : pendingActions) {
 		//The server sends the ScenarioAction to the client, so they can do them.
 		DBG << "Host : applying pending Scenario Action of type "
@@ -87,6 +107,7 @@ void GlobalState::run(sf::Time dt) {
 				&& action->name != "ChangeDestination") {
 			DBG << "Host : sending the action to the network";
 			server->broadcastMessage(*action, true);
+			profiler.count(TickProfiler::MESSAGES_SENT);
 		}
 		DBG << "Nobody : serveur run action";
 		action->run();
@@ -97,42 +118,13 @@ void GlobalState::run(sf::Time dt) {
 	//On supprime les actions déjà traitées
 	toDelete.clear();
 
-	/*on empile les dt jusqu'à obtenir plus d'une seconde*/
-	smallTime = smallTime + dt.asSeconds();
-
-	/*on compte le nombre de secondes dans dt*/
-	int secondes = floor(smallTime);
-	smallTime = smallTime - secondes;
-
-	DBG << "on lisse la matrice ";
-
-	//Si ça fait plus d'une seconde, on fait changer de direction les gens qui ont peur
-	if (secondes > 0) {
-		for (std::pair<const boost::uuids::uuid, NPC*>& pair : NPCs) {
-			NPC* npc = pair.second;
-			if (npc->isShocked()) {
-				this->reroute(*npc);
-			}
-		}
-	}
-
-	/*on n'effectue pas le lissage de la matrice plus d'une fois par seconde*/
-	for (int i = 0; i < secondes; i++) {
-		this->lisserMatrice();
-	}
-
 	/*création des gens selon la densité*/
-	for (int i = 0; i < secondes; i++) {
+	if (newSecond) {
 		//this->peopleGeneration();
 	}
 
-	/* We update the position of all the players */
-	for (Player& player : players) {
-		player.updatePosition(dt, *map);
-	}
-
 	/*on fait payer l'entretien des différents trucs*/
-	for (int i = 0; i < secondes; i++) {
+	if (newSecond) {
 
 		for (Agent* agent : agents) {
 			mesSous = mesSous - agent->getEntretien();
@@ -142,70 +134,101 @@ void GlobalState::run(sf::Time dt) {
 			mesSous = mesSous- camera->getEntretien();
 		}
 	}
+	return;
+}
+
+void GlobalState::runDiffusion(sf::Time dt) {
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::DIFFUSION);
+	DBG << "on lisse la matrice ";
+	/*le lissage de la matrice suit le temps écoulé, à chaque tick*/
+	this->lisserMatrice(dt.asSeconds());
+	return;
+}
+
+void GlobalState::runMovement(sf::Time dt) {
+	std::vector<NPC*> arrived;
+	{
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::MOVEMENT);
+	//les chemins calculés depuis le tick précédent
+	this->applyRoutes();
+
+	//Une fois par seconde, les gens qui ont peur se mettent à fuir : ils
+	//suivent tous le même champ vers les sorties, sans recherche chacun
+	if (scheduler.every(sf::seconds(1))) {
+		for (int i = 0; i < npcs.size(); i++) {
+			if ((npcs.flags[i] & NpcStore::SHOCKED) && npcs.field[i] == nullptr) {
+				this->evacuateNPC(*npcs.getObject(i));
+			}
+		}
+	}
+
+	/* We update the position of all the players */
+	for (Player& player : players) {
+		player.updatePosition(dt, *map);
+	}
 
 	//Deplacement de tous les NPCs.
 	DBG << "on commence à bouger les npcs";
-	for (std::pair<const boost::uuids::uuid, NPC*>& pair : NPCs) {
-		NPC* npc = pair.second;
+	//on calcule le mouvement sur les tableaux du store, en parallèle : chaque
+	//NPC lit l'état du tick précédent et n'écrit que sa case des tableaux next*...
+	Geography& geography = *map;
+	workers->parallelFor(0, npcs.size(), 64, [&](int begin, int end) {
+		NeighbourBatch batch;
+		for (int i = begin; i < end; i++) {
+			Trajectory::step(npcs, i, dt, geography, npcIndex, batch);
+		}
+	});
+	npcs.swapBuffers();
+	//...puis on le reporte sur les NPCs, dans l'ordre du store
+	for (int i = 0; i < npcs.size(); i++) {
+		NPC* npc = npcs.getObject(i);
 		bool wasArrived = npc->hasArrived();
+		if (!(npcs.flags[i] & (NpcStore::ARRIVED | NpcStore::DYING | NpcStore::DEAD))) {
+			profiler.count(TickProfiler::NPCS_MOVED);
+		}
 		Tile& tileBefore = npc->getPosition().isInTile(*map);
-		npc->updatePosition(dt, *map);
-    // FIXME slow
-    // * Don't send updates at every tick?
-    // * Only send updates about visible NPCs to each player?
-    // * Create one update type per attribute?
-    auto update = NpcUpdate(*npc,false);
-    server->broadcastMessage(update,false);
+		npcs.save(i);
+		npc->updateDeath(dt);
 		Tile& tileAfter = npc->getPosition().isInTile(*map);
 		if (!tileBefore.equals(tileAfter)) {
-			/*
-			 * To listen with class C, derive EventListener<C> and then:
-			 *
-			 *   listen("NPC::changedTile",someNPC,&C::someMethod);
-			 *
-			 *   with someNPC a reference to the actual stored NPC
-			 *   and someMethod(NPC& npc, std::pair<Tile,Tile> tilePair)
-			 *   tilePair.first will be tileBefore
-			 *   tilePair.second will be tileAfter
-			 *
-			 * To stop listening later:
-			 *
-			 *   unlisten("NPC::changedTile",someNPC);
-			 */
-			npc->trigger("NPC::changedTile",
-					std::pair<Tile, Tile>(tileBefore, tileAfter));
-			tileBefore.removeNPC(npc);
-			tileAfter.addNPC(npc);
+			this->moveNPC(npc, tileBefore, tileAfter);
 		}
 		// Juste un test pour le EventManager (activer debug dans HScenario.cc pour le voir)
 		if (npc->hasArrived() && !wasArrived) {
-			(*npc).trigger("NPC::arrived");
-      //FIXME send update when NPC is deleted
-			DBG << "suppression d'un NPC";
-			this->supprimerNPC(npc);
+			arrived.push_back(npc);
 		}
 
 		if (DEBUG) {
-			std::list<NPC*> neighbours =
-					(npc)->getPosition().isInTile(*map).getNPCsInRadius(*map,
-							2);
-			while (!neighbours.empty()) {
-				NPC* tempNPC = neighbours.front();
-				neighbours.pop_front();
-				if (tempNPC->getUuid() != (npc)->getUuid()) {
+			std::pair<int, int> tile = npc->getPosition().isInTile();
+			forEachNPCInRadius(tile.first, tile.second, 2, [npc](NPC* tempNPC) {
+				if (tempNPC != npc) {
 					const std::string id1 = boost::lexical_cast<std::string>(
 							npc->getUuid());
 					const std::string id2 = boost::lexical_cast<std::string>(
 							tempNPC->getUuid());
 					printf("NPC %s: neighbour %s\n", id1.c_str(), id2.c_str());
 				}
-			}
+			});
 		}
 	}
+	}
+
+	//on ne supprime qu'après avoir parcouru le store, qui change d'ordre
+	for (NPC* npc : arrived) {
+		(*npc).trigger("NPC::arrived");
+		DBG << "suppression d'un NPC";
+		this->supprimerNPC(npc);
+	}
 
 	for (Player& player : players)
 		DBG << "GlobalState : Position of player " << player.getID() << " : "
 				<< player.getPosition();
+	return;
+}
+
+void GlobalState::runUpdates(sf::Time dt) {
+	//comprend l'envoi des snapshots, compté aussi à part dans BROADCAST
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::UPDATES);
 	server->update(dt);
 	return;
 }
@@ -216,7 +239,6 @@ Server* GlobalState::getServer(void) {
 
 void GlobalState::addNPC(Position start, Position target, float speed, TexturePack* tex, boost::uuids::uuid uuid) {
   NPC* npc = buildNPC(start, target, speed, tex, uuid);
+  //les clients le recevront dans le prochain snapshot, voir UpdateGenerator
   Simulation::addNPC(npc);
-  auto update = NpcUpdate(*npc,true);
-  server->broadcastMessage(update, true);
 }
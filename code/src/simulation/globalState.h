@@ -30,7 +30,43 @@ class GlobalState : public Simulation{
 
   virtual void addNPC(Position start, Position target, float speed, TexturePack* tex, boost::uuids::uuid id = WithUuid::generator());
 
+  /**
+   * @brief run
+   * Runs one tick of the game.
+   * @param dt : the tick length of getScheduler()
+   */
   void run(sf::Time dt);
+
+  /* The phases of run(), in this order. They are public so that they can be
+   * timed separately (see test::bench_sim), but run() should be used
+   * otherwise, it also counts the tick. */
+
+  /**
+   * @brief runActions
+   * receives the actions from the network, runs the pending ScenarioActions
+   * and charges the maintenance costs
+   */
+  void runActions();
+
+  /**
+   * @brief runDiffusion
+   * spreads the anxiety, see lisserMatrice
+   */
+  void runDiffusion(sf::Time dt);
+
+  /**
+   * @brief runMovement
+   * moves the players and the NPCs, and removes the NPCs which arrived ;
+   * the clients learn the moves from the snapshots sent by runUpdates
+   */
+  void runMovement(sf::Time dt);
+
+  /**
+   * @brief runUpdates
+   * lets the server send its periodic GameUpdates, the snapshots of the
+   * NPCs (see UpdateGenerator)
+   */
+  void runUpdates(sf::Time dt);
 private:
     Server *server;
 } ;
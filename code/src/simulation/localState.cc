@@ -86,8 +86,13 @@ std::pair<int, int> LocalState::getCurrentTile() {
 }
 
 void LocalState::run(sf::Time dt) {
+	scheduler.startTick();
+	{
+	TickProfiler::ScopedTimer tickTimer(profiler, TickProfiler::TICK);
 	//If teir is no enough money, remove an agent and a camera
 	//The client retrieve all the new messages from the network (of type ScenarioAction), and add them to the list of pending ScenarioAction
+	{
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::NETWORK);
 	std::vector<ScenarioAction *> scenarioActionFromNetwork =
 			this->client->receiveMessages<ScenarioAction>();
 	for (ScenarioAction* action : scenarioActionFromNetwork) {
@@ -96,68 +101,47 @@ void LocalState::run(sf::Time dt) {
 		action->simulation = this;
 		this->addAction(action);
 	}
+	}
 
+	{
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::ACTIONS);
 	for (ScenarioAction* action : pendingActions) {
 		std::cout << "Client : applying pending Scenario Action of type "
 				<< action->name << std::endl;
 		action->run();
 		std::cout << "nobody client fin run " << std::endl;
 	}
+	}
 
-  
-  auto npcUpdates = client->receiveMessages<NpcUpdate>();
-  for (NpcUpdate* update : npcUpdates) {
-    if (update->isCreated) {
-      NPC* npc = update->createNpc();
-      npc->setTarget(update->target,*map);
-      addNPC(npc);
-    } else {
-      NPC* npc = getNPCByID(update->id);
-      if (npc == nullptr) {
-        throw std::runtime_error("Received network information about nonexistent NPC (maybe we don't care)");
-      } else {
-
-        if (!(npc->getTarget().equal(update->target))) {
-          npc->setTarget(update->target, *map);
-        }
-
-        Tile& tileBefore = npc->getPosition().isInTile(*map);
-        update->updateNpc(*npc);
-        Tile& tileAfter = npc->getPosition().isInTile(*map);
-
-        if (!tileBefore.equals(tileAfter)) {
-          tileBefore.removeNPC(npc);
-          tileAfter.addNPC(npc);
-        }
-
-      }
-    }
+  {
+  TickProfiler::ScopedTimer timer(profiler, TickProfiler::MOVEMENT);
+  //les chemins calculés depuis le tick précédent
+  applyRoutes();
+  /* We update the position of all the players */
+  for (Player& player : players)
+    player.updatePosition(dt, *map);
   }
 
 
 	this->pendingActions.clear();
 	//On supprime les actions déjà traitées
 	this->toDelete.clear();
-	/*on empile les dt jusqu'à obtenir plus d'une seconde*/
-	this->smallTime = smallTime + dt.asSeconds();
-	/*on compte le nombre de secondes dans dt*/
-	int secondes = floor(smallTime);
-	smallTime = smallTime - secondes;
-	/* We update the position of all the players */
-	for (Player& player : players)
-		player.updatePosition(dt, *map);
-	/*on n'effectue pas le lissage de la matrice plus d'une fois par seconde*/
-	for (int i = 0; i < secondes; i++)
-		this->lisserMatrice();
+	/*les tâches périodiques se règlent sur le compteur de ticks*/
+	bool newSecond = scheduler.every(sf::seconds(1));
+	{
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::DIFFUSION);
+	/*le lissage de la matrice suit le temps écoulé, à chaque tick*/
+	this->lisserMatrice(dt.asSeconds());
+	}
 	/*on fait payer l'entretien des différents trucs*/
-	for (int i = 0; i < secondes; i++) {
+	if (newSecond) {
 		for (Agent* agent : agents) {
-			mesSous = mesSous - (i+1)*agent->getEntretien();
+			mesSous = mesSous - agent->getEntretien();
 		}
 		for (Camera* camera : cameras) {
-			mesSous = mesSous - (i+1)*camera->getEntretien();
+			mesSous = mesSous - camera->getEntretien();
 		}
-		mesSous = mesSous + (i+1)*10;
+		mesSous = mesSous + 10;
 	}
 	if (mesSous < 0) {
 			if (!(this->agents.empty())) {
@@ -169,9 +153,50 @@ void LocalState::run(sf::Time dt) {
 		}
 
 	DBG << "LocalState : Position of the Player" << getOwner().getPosition();
+	TickProfiler::ScopedTimer timer(profiler, TickProfiler::UPDATES);
 	client->update(dt);
+	}
+	profiler.endTick(scheduler);
 	return;
 }
+void LocalState::applyNpcUpdate(NpcUpdate& update) {
+  NPC* npc = getNPCByID(update.id);
+  if (update.isCreated && npc == nullptr) {
+    npc = update.createNpc();
+    routeNPC(*npc, update.target);
+    addNPC(npc);
+  } else {
+    if (npc == nullptr) {
+      //un snapshot peut arriver avant la création du NPC ou après sa suppression
+      LOG(warning) << "LocalState : update of unknown NPC " << update.id << ", ignored";
+    } else {
+
+      if ((update.fields & NpcUpdate::TARGET) && !(npc->getTarget().equal(update.target))) {
+        routeNPC(*npc, update.target);
+      }
+
+      Tile& tileBefore = npc->getPosition().isInTile(*map);
+      update.updateNpc(*npc);
+      profiler.count(TickProfiler::NPCS_MOVED);
+      Tile& tileAfter = npc->getPosition().isInTile(*map);
+
+      if (!tileBefore.equals(tileAfter)) {
+        moveNPC(npc, tileBefore, tileAfter);
+      }
+
+    }
+  }
+  return;
+}
+
+void LocalState::removeNpc(boost::uuids::uuid id) {
+  NPC* npc = getNPCByID(id);
+  if (npc != nullptr) {
+    supprimerNPC(npc);
+  }
+  return;
+}
+
 /**
  * @brief LocalState::setClient setting a network client for the local state.
  * After this step we can opereate over the network
@@ -71,10 +71,26 @@ class LocalState : public Simulation{
   sf::Time& getLocalTime();
   /**
    * @brief run
-   * Updates all parameters of local state.
+   * Updates all parameters of local state, for one tick.
+   * @param dt : the tick length of getScheduler()
    */
   void run(sf::Time dt);
 
+  /**
+   * @brief applyNpcUpdate
+   * creates the NPC of an update, or changes the fields it carries in the
+   * existing NPC ; an update of an unknown NPC is logged and ignored
+   * @param update : an update received from the server
+   */
+  void applyNpcUpdate(NpcUpdate& update);
+
+  /**
+   * @brief removeNpc
+   * removes a NPC which no longer exists on the server, if it is here
+   * @param id : the uuid of the NPC
+   */
+  void removeNpc(boost::uuids::uuid id);
+
   private :
   Client* client;
   sf::Time localtime;
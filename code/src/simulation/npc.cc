@@ -3,6 +3,7 @@
  */
 #include "npc.h"
 #include "boost/uuid/uuid_io.hpp"
+#include "flowField.h"
 
 #define DEBUG false
 
@@ -35,6 +36,7 @@ float NPC::getFear() const {
 
 void NPC::setFear(float f) {
   fear = f;
+  syncStore();
   return ;
 }
 
@@ -56,6 +58,7 @@ bool NPC::isDead() {
 
 void NPC::setShocked(bool s) {
   shocked = s;
+  syncStore();
   return;
 }
 
@@ -68,22 +71,19 @@ Position& NPC::getPosition() {
 void NPC::setPosition(Position& p) {
   trajectory.setPosition(p);
   Positionable::setPosition(p);
+  syncStore();
   return;
 }
 
 
-void NPC::updatePosition(sf::Time dt,Geography& map) {
-  if (!dead && !dying) {
-    trajectory.update(dt,speed,map,*this);
-    Positionable::setPosition(trajectory.getPosition());
-  }
-  
+void NPC::updateDeath(sf::Time dt) {
   if (!dead && dying) {
     deathTimeout -= dt;
   }
 
-  if (deathTimeout <= sf::Time::Zero) {
+  if (deathTimeout <= sf::Time::Zero && !dead) {
     dead = true;
+    syncStore();
   }
 
   if(DEBUG) {
@@ -93,6 +93,19 @@ void NPC::updatePosition(sf::Time dt,Geography& map) {
 }
 
 
+NpcHandle NPC::getHandle() const {
+  return handle;
+}
+
+
+void NPC::syncStore() {
+  if (store) {
+    store->load(store->getIndex(handle));
+  }
+  return;
+}
+
+
 float NPC::getHitboxSize() const {
   return hitboxSize;
 }
@@ -129,13 +142,50 @@ void NPC::nextFrame() {
 void NPC::setTarget(Position t, Geography& map) {
   target = t;
   trajectory.setTarget(t,map);
+  syncStore();
   return;
 }
 
 
+void NPC::headTowards(Position t) {
+  target = t;
+  trajectory.headTowards(t);
+  syncStore();
+  return;
+}
+
+
+void NPC::followPath(const RouteCache::Route& path,const NavGrid& grid) {
+  trajectory.followPath(path,grid,target);
+  syncStore();
+  return;
+}
+
+
+bool NPC::repairPath(Geography& map) {
+  bool repaired = trajectory.repairPath(map);
+  syncStore();
+  return repaired;
+}
+
+
+bool NPC::followField(std::shared_ptr<const FlowField> field) {
+  std::pair<int,int> tile = getPosition().isInTile();
+  int goal = field->getGoal(field->getId(tile.first,tile.second));
+  if (goal == -1) {
+    return false;
+  }
+  target = Position(field->getAbs(goal) + 0.5, field->getOrd(goal) + 0.5);
+  trajectory.followField(field,target);
+  syncStore();
+  return true;
+}
+
+
 void NPC::kill() {
   deathTimeout = sf::seconds(5);//il commence à mourir, il sera mort (et delete) dans 5 secondes
   dying = true;
+  syncStore();
   return;
 }
 
@@ -7,6 +7,7 @@
 #include "trajectory.h"
 #include "positionable.h"
 #include "position.h"
+#include "npcStore.h"
 #include "withUuid.h"
 #include "eventSource.h"
 #include <SFML/System.hpp>
@@ -30,6 +31,10 @@ class NPC : public Character, public DrawableObject, public AbstractMessage {
   bool dead;
   sf::Time deathTimeout;
 
+  /* the store of the Simulation the NPC is in, if any */
+  NpcStore* store = nullptr;
+  NpcHandle handle;
+
 
  public:
   virtual AbstractMessage* copy() {
@@ -114,13 +119,25 @@ class NPC : public Character, public DrawableObject, public AbstractMessage {
 
 
   /**
-   * @brief updatePosition
-   * updates the NPC's position
-   * ie tells him to move towards his target for a small time interval
-   * @param dt : the time interval during which the NPC will move
-   * @param map : the map on which the NPC moves
+   * @brief updateDeath
+   * makes a dying NPC die a bit more, he is dead after deathTimeout
+   * (the movement itself is done by Trajectory::step on the NpcStore)
+   * @param dt : the time interval
+   */
+  void updateDeath(sf::Time dt);
+
+  /**
+   * @brief getHandle
+   * @return the NPC's handle in the NpcStore of its Simulation
+   * (the null handle if it is in no Simulation)
    */
-  void updatePosition(sf::Time dt,Geography& map);
+  NpcHandle getHandle() const;
+
+  /**
+   * @brief syncStore
+   * reloads the NPC's entry in its NpcStore after a change of its state
+   */
+  void syncStore();
 
   /**
    * @brief isInHitbox
@@ -158,6 +175,40 @@ class NPC : public Character, public DrawableObject, public AbstractMessage {
    */
   void setTarget(Position t,Geography& map);
 
+  /**
+   * @brief headTowards
+   * sets a new target position for the NPC, whose path will be given later
+   * by followPath, see Trajectory::headTowards
+   * @param t: the new target position
+   */
+  void headTowards(Position t);
+
+  /**
+   * @brief followPath
+   * makes the NPC follow a route to its target, see Trajectory::followPath
+   * @param path: the tiles of the route, not empty, shared with the cache
+   * @param grid: the grid of the map
+   */
+  void followPath(const RouteCache::Route& path,const NavGrid& grid);
+
+  /**
+   * @brief repairPath
+   * makes the NPC go round the blocked tiles on his path, see
+   * Trajectory::repairPath
+   * @param map: the map which will be used for the pathfinding
+   * @return false if his path must be searched again from scratch
+   */
+  bool repairPath(Geography& map);
+
+  /**
+   * @brief followField
+   * makes the NPC follow a flow field to the nearest of its goals, which
+   * becomes his target, see Trajectory::followField
+   * @param field: the field, of the map the NPC is on
+   * @return false if no goal of the field can be reached from where he is
+   */
+  bool followField(std::shared_ptr<const FlowField> field);
+
   /**
    * @brief kill
    * kills the npc, ie tells him he is dying
@@ -185,6 +236,7 @@ class NPC : public Character, public DrawableObject, public AbstractMessage {
   NPC(){} ;
   
   friend class NpcUpdate ;
+  friend class NpcStore ;
   
   SIMPLE_MESSAGE(NPC, AbstractMessage, uuid, position,target, fear, shocked, speed, hitboxSize, deltaT, lambda, Vzero );
 
@@ -0,0 +1,213 @@
+#include "npcStore.h"
+#include "npc.h"
+#include <cassert>
+
+
+NpcStore::NpcStore() {
+}
+
+
+NpcStore::NpcStore(NpcStore&& other) :
+  x(std::move(other.x)), y(std::move(other.y)),
+  vx(std::move(other.vx)), vy(std::move(other.vy)),
+  ax(std::move(other.ax)), ay(std::move(other.ay)),
+  tx(std::move(other.tx)), ty(std::move(other.ty)),
+  speedNorm(std::move(other.speedNorm)), fear(std::move(other.fear)),
+  timer(std::move(other.timer)),
+  deltaT(std::move(other.deltaT)), lambda(std::move(other.lambda)), Vzero(std::move(other.Vzero)),
+  flags(std::move(other.flags)), seed(std::move(other.seed)), field(std::move(other.field)),
+  nextX(std::move(other.nextX)), nextY(std::move(other.nextY)),
+  nextVx(std::move(other.nextVx)), nextVy(std::move(other.nextVy)),
+  nextAx(std::move(other.nextAx)), nextAy(std::move(other.nextAy)),
+  nextTimer(std::move(other.nextTimer)), nextFlags(std::move(other.nextFlags)),
+  nextSeed(std::move(other.nextSeed)),
+  objects(std::move(other.objects)), denseToSlot(std::move(other.denseToSlot)),
+  slots(std::move(other.slots)), freeSlots(std::move(other.freeSlots)),
+  byUuid(std::move(other.byUuid)) {
+  // les NPCs doivent désormais pointer vers ce store
+  for (NPC* npc : objects) {
+    npc->store = this;
+  }
+  other.objects.clear();
+}
+
+
+NpcHandle NpcStore::add(NPC* npc) {
+  assert(npc->store == nullptr);
+  int i = size();
+  unsigned int slot;
+  if (freeSlots.empty()) {
+    slot = slots.size();
+    Slot s = {0, i};
+    slots.push_back(s);
+  } else {
+    slot = freeSlots.back();
+    freeSlots.pop_back();
+    slots[slot].dense = i;
+  }
+  NpcHandle h(slot, slots[slot].generation);
+  objects.push_back(npc);
+  denseToSlot.push_back(slot);
+  resize(i+1);
+  byUuid[npc->getUuid()] = h;
+  npc->store = this;
+  npc->handle = h;
+  seed[i] = boost::hash<boost::uuids::uuid>()(npc->getUuid());
+  load(i);
+  return h;
+}
+
+
+bool NpcStore::remove(NpcHandle h) {
+  int i = getIndex(h);
+  if (i < 0) {
+    return false;
+  }
+  NPC* npc = objects[i];
+  byUuid.erase(npc->getUuid());
+  npc->store = nullptr;
+  npc->handle = NpcHandle();
+
+  // le dernier prend la place du NPC supprimé
+  int last = size()-1;
+  if (i != last) {
+    moveEntry(last, i);
+  }
+  objects.pop_back();
+  denseToSlot.pop_back();
+  resize(last);
+
+  slots[h.slot].generation++;
+  slots[h.slot].dense = -1;
+  freeSlots.push_back(h.slot);
+  return true;
+}
+
+
+void NpcStore::clear() {
+  while (size() > 0) {
+    remove(getHandle(size()-1));
+  }
+  return;
+}
+
+
+int NpcStore::size() const {
+  return objects.size();
+}
+
+
+NPC* NpcStore::get(NpcHandle h) const {
+  int i = getIndex(h);
+  return (i < 0) ? nullptr : objects[i];
+}
+
+
+NpcHandle NpcStore::find(const boost::uuids::uuid& uuid) const {
+  auto it = byUuid.find(uuid);
+  return (it == byUuid.end()) ? NpcHandle() : it->second;
+}
+
+
+void NpcStore::load(int i) {
+  NPC* npc = objects[i];
+  Trajectory& trajectory = npc->trajectory;
+  Position& p = trajectory.getPosition();
+  x[i] = p.getX();
+  y[i] = p.getY();
+  vx[i] = trajectory.speed.first;
+  vy[i] = trajectory.speed.second;
+  ax[i] = trajectory.acceleration.first;
+  ay[i] = trajectory.acceleration.second;
+  if (!trajectory.hasArrived) {
+    Position waypoint = trajectory.getWaypoint();
+    tx[i] = waypoint.getX();
+    ty[i] = waypoint.getY();
+  } else {
+    tx[i] = x[i];
+    ty[i] = y[i];
+  }
+  field[i] = trajectory.hasArrived ? nullptr : trajectory.field.get();
+  speedNorm[i] = npc->speed;
+  fear[i] = npc->fear;
+  timer[i] = trajectory.timeoutIgnoreTarget.asSeconds();
+  deltaT[i] = npc->deltaT;
+  lambda[i] = npc->lambda;
+  Vzero[i] = npc->Vzero;
+  flags[i] = (trajectory.hasArrived ? ARRIVED : 0)
+    | (npc->dying ? DYING : 0)
+    | (npc->dead ? DEAD : 0)
+    | (npc->shocked ? SHOCKED : 0)
+    | (trajectory.ignoreTarget ? IGNORE_TARGET : 0);
+  return;
+}
+
+
+void NpcStore::swapBuffers() {
+  x.swap(nextX); y.swap(nextY);
+  vx.swap(nextVx); vy.swap(nextVy);
+  ax.swap(nextAx); ay.swap(nextAy);
+  timer.swap(nextTimer);
+  flags.swap(nextFlags);
+  seed.swap(nextSeed);
+  return;
+}
+
+
+void NpcStore::save(int i) {
+  NPC* npc = objects[i];
+  Trajectory& trajectory = npc->trajectory;
+  Position p(x[i], y[i]);
+  trajectory.setPosition(p);
+  trajectory.speed = std::pair<float,float>(vx[i], vy[i]);
+  trajectory.acceleration = std::pair<float,float>(ax[i], ay[i]);
+  trajectory.timeoutIgnoreTarget = sf::seconds(timer[i]);
+  trajectory.ignoreTarget = flags[i] & IGNORE_TARGET;
+  if (flags[i] & WAYPOINT_REACHED) {
+    trajectory.reachedWaypoint();
+    load(i);
+  }
+  npc->Positionable::setPosition(trajectory.getPosition());
+  return;
+}
+
+
+void NpcStore::resize(int n) {
+  x.resize(n); y.resize(n);
+  vx.resize(n); vy.resize(n);
+  ax.resize(n); ay.resize(n);
+  tx.resize(n); ty.resize(n);
+  speedNorm.resize(n);
+  fear.resize(n);
+  timer.resize(n);
+  deltaT.resize(n); lambda.resize(n); Vzero.resize(n);
+  flags.resize(n);
+  seed.resize(n);
+  field.resize(n);
+  nextX.resize(n); nextY.resize(n);
+  nextVx.resize(n); nextVy.resize(n);
+  nextAx.resize(n); nextAy.resize(n);
+  nextTimer.resize(n);
+  nextFlags.resize(n);
+  nextSeed.resize(n);
+  return;
+}
+
+
+void NpcStore::moveEntry(int from, int to) {
+  x[to] = x[from]; y[to] = y[from];
+  vx[to] = vx[from]; vy[to] = vy[from];
+  ax[to] = ax[from]; ay[to] = ay[from];
+  tx[to] = tx[from]; ty[to] = ty[from];
+  speedNorm[to] = speedNorm[from];
+  fear[to] = fear[from];
+  timer[to] = timer[from];
+  deltaT[to] = deltaT[from]; lambda[to] = lambda[from]; Vzero[to] = Vzero[from];
+  flags[to] = flags[from];
+  seed[to] = seed[from];
+  field[to] = field[from];
+  objects[to] = objects[from];
+  denseToSlot[to] = denseToSlot[from];
+  slots[denseToSlot[to]].dense = to;
+  return;
+}
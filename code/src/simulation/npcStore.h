@@ -0,0 +1,197 @@
+#ifndef NPC_STORE_H
+#define NPC_STORE_H
+
+#include <vector>
+#include <unordered_map>
+#include <boost/uuid/uuid.hpp>
+#include <boost/functional/hash.hpp>
+
+class NPC;
+class FlowField;
+
+/**
+ * @brief The NpcHandle struct
+ * designates a NPC of a NpcStore
+ * A handle stays valid until the NPC is removed from the store : its slot
+ * then gets a new generation and the old handles are refused.
+ */
+struct NpcHandle {
+  unsigned int slot;
+  unsigned int generation;
+
+  /**
+   * @brief NpcHandle
+   * the null handle, which designates no NPC
+   */
+  NpcHandle() : slot(-1), generation(0) {}
+  NpcHandle(unsigned int slot, unsigned int generation) : slot(slot), generation(generation) {}
+
+  bool isNull() const { return slot == (unsigned int) -1; }
+  bool operator==(const NpcHandle& h) const { return slot == h.slot && generation == h.generation; }
+  bool operator!=(const NpcHandle& h) const { return !(*this == h); }
+};
+
+
+/**
+ * @brief The NpcStore class
+ * stores the NPCs of a Simulation.
+ * The hot kinematic state used by the movement loop is kept as a structure
+ * of arrays, indexed by a dense index in [0,size()[, so that the loop streams
+ * linearly through memory instead of following NPC pointers. The NPC
+ * objects keep everything else (sprite, animation, events, ...).
+ *
+ * The NPC objects stay the reference for the code outside the movement loop :
+ * their mutators reload their entry (see NPC::syncStore) and save() writes
+ * the arrays back to the object once the movement has been computed.
+ *
+ * The movement is double-buffered : it reads the arrays above (the state of
+ * the previous tick) and writes the next* arrays, which swapBuffers() then
+ * turns into the current state. This way it can run in parallel and its
+ * result does not depend on the order in which the NPCs are moved.
+ *
+ * Removing a NPC moves the last one into its dense index, so dense indices
+ * are not stable : keep NpcHandles instead, they are resolved through a
+ * slot map and checked against the slot's generation.
+ */
+class NpcStore {
+ public:
+  /**
+   * @brief The Flag enum
+   * the bits of flags[i]
+   */
+  enum Flag : unsigned char {
+    ARRIVED = 1,
+    DYING = 2,
+    DEAD = 4,
+    SHOCKED = 8,
+    IGNORE_TARGET = 16,
+    WAYPOINT_REACHED = 32 // set by the movement, handled by save()
+  };
+
+  NpcStore();
+  NpcStore(NpcStore&) = delete;
+  NpcStore(NpcStore&& other);
+
+  /**
+   * @brief add
+   * adds a NPC to the store (the store does not own it) and loads its state
+   * @return the handle of the NPC
+   */
+  NpcHandle add(NPC* npc);
+
+  /**
+   * @brief remove
+   * removes a NPC from the store, without deleting it
+   * @return false if the handle was not valid
+   */
+  bool remove(NpcHandle h);
+
+  /**
+   * @brief clear
+   * removes every NPC, without deleting them
+   */
+  void clear();
+
+  /**
+   * @brief size
+   * @return the number of NPCs in the store
+   */
+  int size() const;
+
+  /**
+   * @brief getIndex
+   * @return the current dense index of the NPC, or -1 if the handle is not valid
+   */
+  int getIndex(NpcHandle h) const {
+    if (h.slot >= slots.size() || slots[h.slot].generation != h.generation) {
+      return -1;
+    }
+    return slots[h.slot].dense;
+  }
+
+  /**
+   * @brief get
+   * @return the NPC designated by the handle, or nullptr if it is not valid
+   */
+  NPC* get(NpcHandle h) const;
+
+  /**
+   * @brief find
+   * looks for a NPC by uuid (for the network and the scenario)
+   * @return the handle of the NPC, or the null handle
+   */
+  NpcHandle find(const boost::uuids::uuid& uuid) const;
+
+  /**
+   * @brief getObject
+   * @return the NPC at dense index i
+   */
+  NPC* getObject(int i) const {
+    return objects[i];
+  }
+
+  /**
+   * @brief getHandle
+   * @return the handle of the NPC at dense index i
+   */
+  NpcHandle getHandle(int i) const {
+    return NpcHandle(denseToSlot[i], slots[denseToSlot[i]].generation);
+  }
+
+  /**
+   * @brief load
+   * copies the state of the NPC at dense index i from the object to the arrays
+   */
+  void load(int i);
+
+  /**
+   * @brief swapBuffers
+   * makes the state computed by the movement (the next* arrays) the current state
+   */
+  void swapBuffers();
+
+  /**
+   * @brief save
+   * writes the arrays back to the NPC at dense index i, and moves it to its
+   * next waypoint if WAYPOINT_REACHED is set
+   */
+  void save(int i);
+
+  /* The hot state, indexed by dense index */
+  std::vector<float> x, y;        // position
+  std::vector<float> vx, vy;      // speed
+  std::vector<float> ax, ay;      // acceleration
+  std::vector<float> tx, ty;      // current waypoint
+  std::vector<float> speedNorm;   // the NPC's speed, ie the maximal norm of its speed vector
+  std::vector<float> fear;
+  std::vector<float> timer;       // seconds before (un)ignoring the target, see Trajectory::updateTimer
+  std::vector<float> deltaT, lambda, Vzero; // parameters of the potential, see Character::potential
+  std::vector<unsigned char> flags;
+  std::vector<unsigned int> seed;   // the NPC's own random state, so that the movement is deterministic
+  std::vector<const FlowField*> field; // the field followed instead of the waypoint, see Trajectory::followField
+
+  /* The state computed by the movement, see swapBuffers */
+  std::vector<float> nextX, nextY;
+  std::vector<float> nextVx, nextVy;
+  std::vector<float> nextAx, nextAy;
+  std::vector<float> nextTimer;
+  std::vector<unsigned char> nextFlags;
+  std::vector<unsigned int> nextSeed;
+
+ private:
+  struct Slot {
+    unsigned int generation;
+    int dense; // -1 if the slot is free
+  };
+
+  std::vector<NPC*> objects;
+  std::vector<unsigned int> denseToSlot;
+  std::vector<Slot> slots;
+  std::vector<unsigned int> freeSlots;
+  std::unordered_map<boost::uuids::uuid, NpcHandle, boost::hash<boost::uuids::uuid> > byUuid;
+
+  void resize(int n);
+  void moveEntry(int from, int to);
+};
+
+#endif // NPC_STORE_H
@@ -0,0 +1,122 @@
+#include "pathService.h"
+#include "trajectory.h"
+#include <algorithm>
+
+
+PathService::PathService(int n) : running(0), stopping(false) {
+  for (int i = 0; i < std::max(n, 1); i++) {
+    threads.emplace_back(&PathService::workerLoop, this);
+  }
+}
+
+
+PathService::~PathService() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+  //les callbacks en attente ne seront jamais appelés
+  for (Job* job : queue) {
+    delete job;
+  }
+  for (Job* job : finished) {
+    delete job;
+  }
+  for (Job* job : spare) {
+    delete job;
+  }
+}
+
+
+void PathService::request(Geography& map,int start,int goal,Callback done) {
+  long long key = ((long long) start << 32) | (unsigned int) goal;
+  auto same = sinceLastPoll.find(key);
+  if (same != sinceLastPoll.end() && same->second->map == &map) {
+    same->second->waiting.push_back(done);
+    return;
+  }
+
+  Job* job;
+  if (spare.empty()) {
+    job = new Job();
+  } else {
+    job = spare.back();
+    spare.pop_back();
+  }
+  job->map = &map;
+  job->start = start;
+  job->goal = goal;
+  job->waiting.clear();
+  job->waiting.push_back(done);
+  sinceLastPoll[key] = job;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    queue.push_back(job);
+  }
+  wake.notify_one();
+  return;
+}
+
+
+int PathService::poll() {
+  polled.clear();
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    polled.swap(finished);
+  }
+  sinceLastPoll.clear();
+  int called = 0;
+  for (Job* job : polled) {
+    for (Callback& done : job->waiting) {
+      done(job->route);
+      called++;
+    }
+    job->waiting.clear();
+    job->route.reset();
+    spare.push_back(job);
+  }
+  return called;
+}
+
+
+int PathService::finish() {
+  {
+    std::unique_lock<std::mutex> guard(lock);
+    idle.wait(guard, [this] { return queue.empty() && running == 0; });
+  }
+  return poll();
+}
+
+
+int PathService::getPendingCount() {
+  std::lock_guard<std::mutex> guard(lock);
+  return (int) queue.size() + running;
+}
+
+
+void PathService::workerLoop() {
+  std::unique_lock<std::mutex> guard(lock);
+  while (true) {
+    wake.wait(guard, [this] { return stopping || !queue.empty(); });
+    if (stopping) {
+      return;
+    }
+    Job* job = queue.front();
+    queue.pop_front();
+    running++;
+    guard.unlock();
+
+    job->route = Trajectory::findPath(*job->map, job->start, job->goal);
+
+    guard.lock();
+    running--;
+    finished.push_back(job);
+    if (queue.empty() && running == 0) {
+      idle.notify_all();
+    }
+  }
+}
@@ -0,0 +1,97 @@
+#ifndef PATH_SERVICE_H
+#define PATH_SERVICE_H
+
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "routeCache.h"
+
+class Geography;
+
+/**
+ * @brief The PathService class
+ * finds routes (see Trajectory::findPath) on its own threads, so that a
+ * burst of requests does not stall the tick.
+ * A request is queued with a callback, which is called with the route by
+ * poll() on the thread that polls, typically the simulation thread once per
+ * tick : the callbacks can touch the simulation without locking.
+ * The requests for the same start and goal tiles made between two polls
+ * share one computation.
+ */
+class PathService {
+ public:
+  /**
+   * @brief Callback
+   * receives the route, or null if the goal cannot be reached
+   */
+  typedef std::function<void(const RouteCache::Route& route)> Callback;
+
+  /**
+   * @brief PathService
+   * @param threads : the number of threads computing the routes
+   */
+  explicit PathService(int threads = 2);
+  PathService(PathService&) = delete;
+  ~PathService();
+
+  /**
+   * @brief request
+   * queues the computation of a route between two tiles
+   * @param map : the map, which must outlive the request
+   * @param start : the id of the first tile, see NavGrid
+   * @param goal : the id of the last tile
+   * @param done : called by poll() once the route is known
+   */
+  void request(Geography& map,int start,int goal,Callback done);
+
+  /**
+   * @brief poll
+   * calls the callbacks of the finished requests
+   * @return the number of callbacks called
+   */
+  int poll();
+
+  /**
+   * @brief finish
+   * waits for every queued request to be computed, then polls
+   * @return the number of callbacks called
+   */
+  int finish();
+
+  /**
+   * @brief getPendingCount
+   * @return the number of computations queued or running
+   */
+  int getPendingCount();
+
+ private:
+  struct Job {
+    Geography* map;
+    int start;
+    int goal;
+    std::vector<Callback> waiting;
+    RouteCache::Route route;
+  };
+
+  std::mutex lock;
+  std::condition_variable wake;     // une tâche ou l'arrêt
+  std::condition_variable idle;     // plus rien en cours
+  std::deque<Job*> queue;
+  std::vector<Job*> finished;
+  int running;
+  bool stopping;
+  std::vector<std::thread> threads;
+
+  /* seulement pour le thread qui appelle request et poll */
+  std::unordered_map<long long,Job*> sinceLastPoll;
+  std::vector<Job*> spare;
+  std::vector<Job*> polled;
+
+  void workerLoop();
+};
+
+#endif // PATH_SERVICE_H
@@ -0,0 +1,258 @@
+#include "pathfinder.h"
+#include "../generation/navGrid.h"
+#include "../generation/landmarks.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+
+/**
+ * @brief the euclidean distance to the goal, or the bound of the landmarks
+ * if it is better
+ */
+static float heuristic(const NavGrid& grid,int node,int goal,const Landmarks* landmarks) {
+  float di = grid.getAbs(node) - grid.getAbs(goal);
+  float dj = grid.getOrd(node) - grid.getOrd(goal);
+  float h = std::sqrt(di*di + dj*dj);
+  if (landmarks) {
+    h = std::max(h, landmarks->lowerBound(node, goal));
+  }
+  return h;
+}
+
+
+/**
+ * @brief the difference of ids made by a move
+ */
+static int step(const NavGrid& grid,unsigned char move) {
+  switch (move) {
+  case NavGrid::UP:
+    return 1;
+  case NavGrid::DOWN:
+    return -1;
+  case NavGrid::RIGHT:
+    return grid.getHeight();
+  default:
+    return -grid.getHeight();
+  }
+}
+
+
+Pathfinder::Pathfinder() {
+  search = 0;
+  expanded = 0;
+  heapOperations = 0;
+  return;
+}
+
+
+Pathfinder& Pathfinder::local() {
+  static thread_local Pathfinder pathfinder;
+  return pathfinder;
+}
+
+
+void Pathfinder::begin(int size) {
+  if ((int) g.size() < size) {
+    g.resize(size);
+    parent.resize(size);
+    seen.resize(size, 0);
+    closed.resize(size, 0);
+    direction.resize(size);
+  }
+  search++;
+  if (search == 0) {
+    //le compteur a fait le tour : les vieux tampons redeviendraient valides
+    std::fill(seen.begin(), seen.end(), 0);
+    std::fill(closed.begin(), closed.end(), 0);
+    search = 1;
+  }
+  open.clear();
+  expanded = 0;
+  heapOperations = 0;
+  return;
+}
+
+
+bool Pathfinder::findPath(const NavGrid& grid,int start,int goal,std::vector<int>& path,
+                          const Landmarks* landmarks,Mode mode) {
+  if (mode == JPS || (mode == AUTO && grid.isSymmetric())) {
+    return findJumpPath(grid, start, goal, path, landmarks);
+  }
+  begin(grid.getSize());
+  path.clear();
+
+  g[start] = 0;
+  parent[start] = -1;
+  seen[start] = search;
+  open.push_back(Entry{heuristic(grid, start, goal, landmarks), 0, start});
+  heapOperations++;
+
+  bool found = false;
+  int neighbours[4];
+  //boucle principale de A*
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), After());
+    Entry e = open.back();
+    open.pop_back();
+    heapOperations++;
+    //une tile peut être dans le tas plusieurs fois, seule la première compte
+    if (closed[e.node] == search) {
+      continue;
+    }
+    if (e.node == goal) {
+      found = true;
+      break;
+    }
+    closed[e.node] = search;
+    expanded++;
+
+    int n = grid.getNeighbours(e.node, neighbours);
+    for (int k = 0; k < n; k++) {
+      int y = neighbours[k];
+      if (closed[y] == search) {
+        continue;
+      }
+      float d = e.g + 1;
+      if (seen[y] != search || d < g[y]) {
+        seen[y] = search;
+        g[y] = d;
+        parent[y] = e.node;
+        open.push_back(Entry{d + heuristic(grid, y, goal, landmarks), d, y});
+        std::push_heap(open.begin(), open.end(), After());
+        heapOperations++;
+      }
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  for (int node = goal; node != -1; node = parent[node]) {
+    path.push_back(node);
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
+
+
+unsigned char Pathfinder::forced(const NavGrid& grid,int p,int x,unsigned char dir) {
+  unsigned char mx = grid.getMoves(x), mp = grid.getMoves(p);
+  unsigned char f = 0;
+  //x-1 colonne : on y va aussi bien en tournant dans p, sauf si un mur l'empêche
+  if ((mx & NavGrid::LEFT) && !((mp & NavGrid::LEFT) && (grid.getMoves(p-grid.getHeight()) & dir))) {
+    f |= NavGrid::LEFT;
+  }
+  if ((mx & NavGrid::RIGHT) && !((mp & NavGrid::RIGHT) && (grid.getMoves(p+grid.getHeight()) & dir))) {
+    f |= NavGrid::RIGHT;
+  }
+  return f;
+}
+
+
+int Pathfinder::jumpVertical(const NavGrid& grid,int x,unsigned char dir,int goal) {
+  int s = step(grid, dir);
+  while (grid.getMoves(x) & dir) {
+    int p = x;
+    x += s;
+    if (x == goal || forced(grid, p, x, dir) != 0) {
+      return x;
+    }
+  }
+  return -1;
+}
+
+
+int Pathfinder::jumpHorizontal(const NavGrid& grid,int x,unsigned char dir,int goal) {
+  int s = step(grid, dir);
+  while (grid.getMoves(x) & dir) {
+    x += s;
+    //on peut toujours tourner après un déplacement horizontal
+    if (x == goal || jumpVertical(grid, x, NavGrid::UP, goal) != -1
+        || jumpVertical(grid, x, NavGrid::DOWN, goal) != -1) {
+      return x;
+    }
+  }
+  return -1;
+}
+
+
+bool Pathfinder::findJumpPath(const NavGrid& grid,int start,int goal,std::vector<int>& path,
+                              const Landmarks* landmarks) {
+  begin(grid.getSize());
+  path.clear();
+
+  g[start] = 0;
+  parent[start] = -1;
+  seen[start] = search;
+  direction[start] = 0;
+  open.push_back(Entry{heuristic(grid, start, goal, landmarks), 0, start});
+  heapOperations++;
+
+  static const unsigned char all[4] = {NavGrid::UP, NavGrid::RIGHT, NavGrid::LEFT, NavGrid::DOWN};
+  bool found = false;
+  while (!open.empty()) {
+    std::pop_heap(open.begin(), open.end(), After());
+    Entry e = open.back();
+    open.pop_back();
+    heapOperations++;
+    if (closed[e.node] == search) {
+      continue;
+    }
+    if (e.node == goal) {
+      found = true;
+      break;
+    }
+    closed[e.node] = search;
+    expanded++;
+
+    //les directions qu'un plus court chemin peut prendre en arrivant ici :
+    //tout droit, et tourner après un déplacement horizontal ou si c'est forcé
+    int x = e.node;
+    unsigned char d = direction[x];
+    unsigned char m = grid.getMoves(x);
+    unsigned char dirs;
+    if (d == 0) {
+      dirs = m;
+    } else if (d == NavGrid::LEFT || d == NavGrid::RIGHT) {
+      dirs = m & (d | NavGrid::UP | NavGrid::DOWN);
+    } else {
+      dirs = m & (d | forced(grid, x - step(grid, d), x, d));
+    }
+    for (unsigned char dir : all) {
+      if (!(dirs & dir)) {
+        continue;
+      }
+      int y = (dir == NavGrid::UP || dir == NavGrid::DOWN) ? jumpVertical(grid, x, dir, goal)
+        : jumpHorizontal(grid, x, dir, goal);
+      if (y == -1 || closed[y] == search) {
+        continue;
+      }
+      float dist = e.g + std::abs(grid.getAbs(y) - grid.getAbs(x)) + std::abs(grid.getOrd(y) - grid.getOrd(x));
+      if (seen[y] != search || dist < g[y]) {
+        seen[y] = search;
+        g[y] = dist;
+        parent[y] = x;
+        direction[y] = dir;
+        open.push_back(Entry{dist + heuristic(grid, y, goal, landmarks), dist, y});
+        std::push_heap(open.begin(), open.end(), After());
+        heapOperations++;
+      }
+    }
+  }
+  if (!found) {
+    return false;
+  }
+
+  //les points de saut sont alignés deux à deux : on remet les tiles entre eux
+  path.push_back(goal);
+  for (int node = goal; parent[node] != -1; node = parent[node]) {
+    int s = step(grid, direction[node]);
+    for (int x = node - s; x != parent[node]; x -= s) {
+      path.push_back(x);
+    }
+    path.push_back(parent[node]);
+  }
+  std::reverse(path.begin(), path.end());
+  return true;
+}
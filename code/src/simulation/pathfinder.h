@@ -0,0 +1,139 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+#include <vector>
+
+class NavGrid;
+class Landmarks;
+
+/**
+ * @brief The Pathfinder class
+ * an A* on a NavGrid, with unit moves and the euclidean distance as
+ * heuristic, or the best of it and the bound given by Landmarks if the map
+ * has some.
+ * The search state lives in the Pathfinder, not in the tiles : flat arrays
+ * indexed by tile id, and a binary heap. A tile is known to the current
+ * search iff its stamp equals the search number, so nothing has to be
+ * cleared between two searches, and once the arrays have grown to the size
+ * of the map a search allocates nothing.
+ * A Pathfinder serves one search at a time ; use one per thread, see local.
+ * Every move costing 1, the search can also jump over the tiles where
+ * nothing happens (Jump Point Search, in its 4-connected version) : only the
+ * tiles where a shortest path may have to turn go to the heap, the others
+ * are scanned in straight lines. This needs moves which can all be made
+ * backwards (NavGrid::isSymmetric) and gives paths of the same length as the
+ * plain A*.
+ */
+class Pathfinder {
+ public:
+  /* the search used by findPath */
+  enum Mode {
+    ASTAR, // every tile goes to the heap
+    JPS,   // Jump Point Search, the grid must be symmetric
+    AUTO   // JPS if the grid is symmetric, A* otherwise
+  };
+
+  Pathfinder();
+  Pathfinder(Pathfinder&) = delete;
+
+  /**
+   * @brief findPath
+   * computes a shortest path between two tiles
+   * @param grid : the moves allowed
+   * @param start : the id of the first tile
+   * @param goal : the id of the last tile
+   * @param path : filled with the ids of the tiles of the path, start and
+   * goal included, if there is one
+   * @param landmarks : the landmarks of the grid, or nullptr
+   * @param mode : the search to use
+   * @return true iff goal can be reached from start
+   */
+  bool findPath(const NavGrid& grid,int start,int goal,std::vector<int>& path,
+                const Landmarks* landmarks = nullptr,Mode mode = AUTO);
+
+  /**
+   * @brief getExpanded
+   * @return the number of tiles expanded by the last search, the jump points
+   * only for a JPS
+   */
+  int getExpanded() const {
+    return expanded;
+  }
+
+  /**
+   * @brief getHeapOperations
+   * @return the number of pushes and pops on the open list by the last search
+   */
+  int getHeapOperations() const {
+    return heapOperations;
+  }
+
+  /**
+   * @brief local
+   * @return the Pathfinder of the calling thread
+   */
+  static Pathfinder& local();
+
+ private:
+  struct Entry {
+    float f;
+    float g;
+    int node;
+  };
+
+  /* ordre du tas : plus petit f d'abord, à f égal le plus avancé */
+  struct After {
+    bool operator()(const Entry& a,const Entry& b) const {
+      return a.f > b.f || (a.f == b.f && a.g < b.g);
+    }
+  };
+
+  std::vector<float> g;
+  std::vector<int> parent;
+  std::vector<unsigned int> seen;   // search number when g was set
+  std::vector<unsigned int> closed; // search number when expanded
+  std::vector<unsigned char> direction; // JPS : the move which led to the tile
+  unsigned int search;
+  std::vector<Entry> open;
+  int expanded;
+  int heapOperations;
+
+  /**
+   * @brief begin
+   * starts a new search on a grid of size tiles
+   */
+  void begin(int size);
+
+  /**
+   * @brief forced
+   * the moves sideways from x, reached from p by the vertical move dir, which
+   * a shortest path could not make by turning in p instead
+   * @return a combination of NavGrid::LEFT and NavGrid::RIGHT
+   */
+  static unsigned char forced(const NavGrid& grid,int p,int x,unsigned char dir);
+
+  /**
+   * @brief jumpVertical
+   * goes from x by the move dir (UP or DOWN) until a tile with forced moves
+   * or the goal
+   * @return the tile found, -1 if a wall was hit first
+   */
+  static int jumpVertical(const NavGrid& grid,int x,unsigned char dir,int goal);
+
+  /**
+   * @brief jumpHorizontal
+   * goes from x by the move dir (LEFT or RIGHT) until a tile from which a
+   * vertical jump finds something, or the goal
+   * @return the tile found, -1 if a wall was hit first
+   */
+  static int jumpHorizontal(const NavGrid& grid,int x,unsigned char dir,int goal);
+
+  /**
+   * @brief findJumpPath
+   * the JPS version of findPath, path being filled with every tile
+   */
+  bool findJumpPath(const NavGrid& grid,int start,int goal,std::vector<int>& path,
+                    const Landmarks* landmarks);
+};
+
+#endif // PATHFINDER_H
@@ -179,6 +179,7 @@ void Player::updatePosition(sf::Time dt, Geography& map) {
       position.add(dep * (dX/(aX+aY)), dep * (dY/(aX+aY)));
       DBG << "  pos'    : " << position;
     }
+    checkChangedTile(x, y);
 
   } else {
 
@@ -274,6 +275,7 @@ void Player::updatePosition(sf::Time dt, Geography& map) {
   if (!(x == position.getX() && y == position.getY())) {
     DBG << position.getX() << " + " << position.getY();
   }
+  checkChangedTile(x, y);
   return;
   }
 }
@@ -4,6 +4,7 @@
 #include "position.h"
 #include "../generation/tile.h"
 #include "npc.h"
+#include "simulation.h"
 #include <cmath>
 
 Position::Position() {
@@ -38,30 +39,20 @@ float Position::getY() const {
 
 
 void Position::setX(float x) {
-  int xt = floor(this->x), xn = floor(x), yf = floor(y);
   this->x = x;
-  if(xt != xn)
-    trigger("Position::changedTile", std::pair<Coordinates,Coordinates>(Coordinates(xt,yf),Coordinates(xn,yf)));
   return;
 }
 
 
 void Position::setY(float y) {
-  int yt = floor(this->y), yn = floor(y), xf = floor(x);
   this->y = y;
-  if(yt != yn)
-    trigger("Position::changedTile", std::pair<Coordinates,Coordinates>(Coordinates(xf, yt),Coordinates(xf,yn)));
-
   return;
 }
 
 
 void Position::add(float a,float b) {
-  int x1 = floor(x), x2 = floor(x+a), y1 = floor(y), y2 = floor(y+b);
   x+=a;
   y+=b;
-  if(x1 != x2 || y1 != y2)
-    trigger("Position::changedTile", std::pair<Coordinates,Coordinates>(Coordinates(x1,y1),Coordinates(x2,y2)));
   return;
 }
 
@@ -92,18 +83,16 @@ bool Position::equal(const Position &p) const {
 }
 
 
-std::list<NPC*> Position::getNPCList(Geography& map) {
+std::list<NPC*> Position::getNPCList(Simulation& simulation) {
   std::list<NPC*> npcList;
-  //get the list of all NPCs around this position
-  std::list<NPC*> notTooFarNPCs = isInTile(map).getNPCsInRadius(map,3);
-  while (!notTooFarNPCs.empty()) {
+  //look at all NPCs around this position
+  std::pair<int,int> tile = isInTile();
+  simulation.forEachNPCInRadius(tile.first,tile.second,3,[&](NPC* npc) {
     // keep only those who are alive and whose hitbox contains the position
-    NPC* npc = notTooFarNPCs.front();
-    notTooFarNPCs.pop_front();
     if (npc->isInHitbox(*this) && !(npc->isDying())&& !(npc->isDead())) {
       npcList.push_front(npc);
     }
-  }
+  });
   return npcList;
 }
 
@@ -5,25 +5,29 @@
 #define POSITION_H
 
 #include <utility>
+#include <type_traits>
 #include "geography.h"
 #include "network/abstractMessage.h"
-#include "simulation/eventSource.h"
 
 
 class Tile;
 class Coordinates;
 class Geography;
 class NPC;
+class Simulation;
 
 
 /**
  * @brief The Position class
  * is a couple of floats with some useful methods
+ * It is a plain value type : it has no identity and does not trigger any
+ * event, so it is cheap to create, copy and destroy. Tile changes are
+ * reported by the owner of the Position (see Positionable::checkChangedTile).
  */
-class Position : public EventSource {
+class Position {
  private:
-  int TILE_SIZE_X = 1;
-  int TILE_SIZE_Y = 1;
+  static const int TILE_SIZE_X = 1;
+  static const int TILE_SIZE_Y = 1;
   float x;
   float y;
 
@@ -118,13 +122,16 @@ class Position : public EventSource {
   /**
    * @brief getNPCList
    * computes the list of the alive NPCs whose hitbox contains the position
+   * @param simulation : the simulation in which the NPCs are looked for
    */
-  std::list<NPC*> getNPCList(Geography& map);
+  std::list<NPC*> getNPCList(Simulation& simulation);
 
   SIMPLE_SERIALIZATION(x,y)
 
     };
 
+static_assert(std::is_trivially_copyable<Position>::value, "Position must stay a plain value type");
+
 /**
  * @brief operator << : used to print debug info
  * @param os
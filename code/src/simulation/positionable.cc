@@ -3,37 +3,33 @@
  */
 #include "positionable.h"
 #include "position.h"
+#include <cmath>
 
 Positionable::Positionable() : FogDisabler() {
   position = Position();
-  listen("Position::changedTile",position,&Positionable::changedTile);
   return;
 }
 
 
-Positionable::Positionable(boost::uuids::uuid uuid) : WithUuid(uuid), FogDisabler(), EventSource(), EventListener<Positionable>() {
+Positionable::Positionable(boost::uuids::uuid uuid) : WithUuid(uuid), FogDisabler(), EventSource() {
   position = Position();
-  listen("Position::changedTile",position,&Positionable::changedTile);
   return;
 }
 
 
 Positionable::Positionable(float x,float y) : FogDisabler() {
   position = Position(x,y);
-  listen("Position::changedTile",position,&Positionable::changedTile);
   return;
 }
 
 
 Positionable::Positionable(Position& p) : FogDisabler() {
   position = Position(p);
-  listen("Position::changedTile",position,&Positionable::changedTile);
   return;
 }
 
 Positionable::Positionable(Position& p, boost::uuids::uuid uuid) : WithUuid(uuid) {
   position = Position(p);
-  listen("Position::changedTile",position,&Positionable::changedTile);
   return;
 }
 
@@ -43,14 +39,19 @@ Position& Positionable::getPosition() {
 
 
 void Positionable::setPosition(Position& p) {
-  position.setX(p.getX());
-  position.setY(p.getY());
+  float oldX = position.getX();
+  float oldY = position.getY();
+  position = p;
+  checkChangedTile(oldX, oldY);
   return;
 }
 
-void Positionable::changedTile(Position& p, std::pair<Coordinates,Coordinates> mod)
+void Positionable::checkChangedTile(float oldX, float oldY)
 {
-  trigger("Positionable::changedTile",std::pair<Coordinates,Coordinates>(mod));
+  int x1 = floor(oldX), y1 = floor(oldY);
+  int x2 = floor(position.getX()), y2 = floor(position.getY());
+  if (x1 != x2 || y1 != y2)
+    trigger("Positionable::changedTile", std::pair<Coordinates,Coordinates>(Coordinates(x1,y1),Coordinates(x2,y2)));
   return;
 }
 
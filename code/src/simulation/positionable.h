@@ -6,13 +6,14 @@
 #include "position.h"
 #include "graphism/fogDisabler.h"
 #include "eventSource.h"
-#include "eventListener.h"
 
 /**
  * @brief The Positionable class
  * only contains a Position and methods to get and set it
+ * It is the event source for position changes : "Positionable::changedTile"
+ * is triggered whenever the Positionable enters a new tile.
  */
-class Positionable : public FogDisabler, public EventSource, public EventListener<Positionable>, public WithUuid {
+class Positionable : public FogDisabler, public EventSource, public WithUuid {
  protected:
  public:
 
@@ -72,11 +73,14 @@ class Positionable : public FogDisabler, public EventSource, public EventListene
   virtual void setPosition(Position& p);
 
   /**
-   * @brief changedTile
-   * triggers the an event using mod
+   * @brief checkChangedTile
+   * triggers "Positionable::changedTile" if the Positionable is not in the
+   * same tile as (oldX,oldY) anymore
+   * Must be called by any code moving the Positionable without setPosition.
+   * @param oldX : the x coordinate before the move
+   * @param oldY : the y coordinate before the move
    */
-  void changedTile(Position& p, std::pair<Coordinates,Coordinates> mod); 
-  /*[Joseph]Je ne sais pas du tout à quoi sert cette fonction ni qui l'a mise là, je la laisse car ce n'est sûrement pas pour rien qu'elle est là…*/
+  void checkChangedTile(float oldX, float oldY);
 
 };
 #endif
@@ -0,0 +1,295 @@
+#include "roadGraph.h"
+#include "pathfinder.h"
+#include "../generation/navGrid.h"
+#include "../generation/geography.h"
+#include "../generation/tile.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <utility>
+
+
+/**
+ * @brief the state of a route search, kept by each thread from one search to
+ * the next
+ */
+struct RouteSearch {
+  std::vector<float> dist;
+  std::vector<int> prev;          // intersection d'où l'on vient
+  std::vector<int> via;           // arête empruntée, -1 pour un départ
+  std::vector<unsigned int> seen;
+  unsigned int search = 0;
+  std::vector<std::pair<float,int>> open;
+  std::vector<int> chain;
+  std::vector<int> leg;
+};
+
+
+/**
+ * @brief flood
+ * gives the number next to every tile reachable from first through tiles of
+ * the same type
+ */
+static void flood(Geography& map,const NavGrid& grid,int first,int number,
+                  std::vector<int>& of,std::vector<int>& queue) {
+  TileType type = map.getTile(grid.getAbs(first),grid.getOrd(first))->getType();
+  queue.clear();
+  queue.push_back(first);
+  of[first] = number;
+  int neighbours[4];
+  for (size_t q = 0; q < queue.size(); q++) {
+    int n = grid.getNeighbours(queue[q], neighbours);
+    for (int k = 0; k < n; k++) {
+      int y = neighbours[k];
+      if (of[y] == -1 && map.getTile(grid.getAbs(y),grid.getOrd(y))->getType() == type) {
+        of[y] = number;
+        queue.push_back(y);
+      }
+    }
+  }
+  return;
+}
+
+
+RoadGraph::RoadGraph(Geography& map,const NavGrid& grid) {
+  int size = grid.getSize();
+  intersectionOf.assign(size, -1);
+  segmentOf.assign(size, -1);
+
+  //les blocs de tiles de même type
+  std::vector<int> queue;
+  int segments = 0;
+  for (int id = 0; id < size; id++) {
+    TileType type = map.getTile(grid.getAbs(id),grid.getOrd(id))->getType();
+    if (type == INTER && intersectionOf[id] == -1) {
+      flood(map, grid, id, (int) centers.size(), intersectionOf, queue);
+      //le centre est la tile du bloc la plus proche de sa moyenne
+      float i = 0, j = 0;
+      for (int t : queue) {
+        i += grid.getAbs(t);
+        j += grid.getOrd(t);
+      }
+      i /= queue.size();
+      j /= queue.size();
+      int center = queue.front();
+      float best = std::numeric_limits<float>::max();
+      for (int t : queue) {
+        float d = std::abs(grid.getAbs(t) - i) + std::abs(grid.getOrd(t) - j);
+        if (d < best) {
+          best = d;
+          center = t;
+        }
+      }
+      centers.push_back(center);
+    } else if ((type == ROADH || type == ROADV) && segmentOf[id] == -1) {
+      flood(map, grid, id, segments++, segmentOf, queue);
+    }
+  }
+
+  //les intersections au bout de chaque segment
+  std::vector<std::vector<int>> touched(segments);
+  int neighbours[4];
+  for (int id = 0; id < size; id++) {
+    if (segmentOf[id] == -1) {
+      continue;
+    }
+    std::vector<int>& t = touched[segmentOf[id]];
+    int n = grid.getNeighbours(id, neighbours);
+    for (int k = 0; k < n; k++) {
+      int x = intersectionOf[neighbours[k]];
+      if (x != -1 && std::find(t.begin(), t.end(), x) == t.end()) {
+        t.push_back(x);
+      }
+    }
+  }
+  segmentBegin.push_back(0);
+  for (int s = 0; s < segments; s++) {
+    ends.insert(ends.end(), touched[s].begin(), touched[s].end());
+    segmentBegin.push_back((int) ends.size());
+  }
+
+  //une arête par couple d'intersections reliées par un segment
+  std::vector<std::pair<int,Edge>> found;
+  std::vector<int> path;
+  for (int s = 0; s < segments; s++) {
+    for (int a = segmentBegin[s]; a < segmentBegin[s+1]; a++) {
+      for (int b = a+1; b < segmentBegin[s+1]; b++) {
+        int from = ends[a], to = ends[b];
+        if (!Pathfinder::local().findPath(grid, centers[from], centers[to], path)) {
+          continue;
+        }
+        //on ne garde que les tournants, dans les deux sens
+        int first = (int) waypoints.size();
+        for (size_t k = 1; k+1 < path.size(); k++) {
+          if (!grid.isAligned(path[k-1], path[k], path[k+1])) {
+            waypoints.push_back(path[k]);
+          }
+        }
+        int count = (int) waypoints.size() - first;
+        for (int k = first+count-1; k >= first; k--) {
+          waypoints.push_back(waypoints[k]);
+        }
+        float cost = (float) path.size() - 1;
+        found.push_back(std::make_pair(from, Edge{to, cost, first, count}));
+        found.push_back(std::make_pair(to, Edge{from, cost, first+count, count}));
+      }
+    }
+  }
+  std::stable_sort(found.begin(), found.end(),
+                   [](const std::pair<int,Edge>& a, const std::pair<int,Edge>& b) {
+                     return a.first < b.first;
+                   });
+  edgeBegin.assign(centers.size()+1, 0);
+  for (auto& e : found) {
+    edgeBegin[e.first+1]++;
+    edges.push_back(e.second);
+  }
+  for (size_t k = 0; k < centers.size(); k++) {
+    edgeBegin[k+1] += edgeBegin[k];
+  }
+  std::vector<std::atomic<bool>> o(edges.size());
+  open.swap(o);
+  for (auto& e : open) {
+    e.store(true, std::memory_order_relaxed);
+  }
+  return;
+}
+
+
+int RoadGraph::refresh(const NavGrid& grid) {
+  int closed = 0;
+  for (int x = 0; x < (int) centers.size(); x++) {
+    for (int e = edgeBegin[x]; e < edgeBegin[x+1]; e++) {
+      //le chemin va du centre de x au centre de edges[e].to en passant par ses tournants
+      int from = centers[x];
+      bool clear = true;
+      for (int k = edges[e].first; k < edges[e].first+edges[e].count && clear; k++) {
+        clear = grid.isClear(from, waypoints[k]);
+        from = waypoints[k];
+      }
+      clear = clear && grid.isClear(from, centers[edges[e].to]);
+      open[e].store(clear, std::memory_order_relaxed);
+      if (!clear) {
+        closed++;
+      }
+    }
+  }
+  return closed;
+}
+
+
+int RoadGraph::link(const NavGrid& grid,int tile,int nodes[4],float costs[4]) const {
+  int n = 0;
+  if (intersectionOf[tile] != -1) {
+    nodes[n++] = intersectionOf[tile];
+  } else if (segmentOf[tile] != -1) {
+    int s = segmentOf[tile];
+    for (int k = segmentBegin[s]; k < segmentBegin[s+1] && n < 4; k++) {
+      nodes[n++] = ends[k];
+    }
+  }
+  for (int k = 0; k < n; k++) {
+    int c = centers[nodes[k]];
+    costs[k] = std::abs(grid.getAbs(c) - grid.getAbs(tile)) + std::abs(grid.getOrd(c) - grid.getOrd(tile));
+  }
+  return n;
+}
+
+
+bool RoadGraph::findRoute(const NavGrid& grid,int start,int goal,std::vector<int>& tiles,
+                          const Landmarks* landmarks) const {
+  int startNodes[4], goalNodes[4];
+  float startCosts[4], goalCosts[4];
+  int ns = link(grid, start, startNodes, startCosts);
+  int ng = link(grid, goal, goalNodes, goalCosts);
+  //hors du réseau, ou si proches que le graphe n'apporte rien
+  bool near = (ns == 0 || ng == 0);
+  for (int a = 0; a < ns && !near; a++) {
+    for (int b = 0; b < ng; b++) {
+      near = near || startNodes[a] == goalNodes[b];
+    }
+  }
+  if (near) {
+    return Pathfinder::local().findPath(grid, start, goal, tiles, landmarks);
+  }
+
+  static thread_local RouteSearch r;
+  int nodes = (int) centers.size();
+  int target = nodes; // noeud virtuel : l'arrivée
+  if ((int) r.dist.size() < nodes+1) {
+    r.dist.resize(nodes+1);
+    r.prev.resize(nodes+1);
+    r.via.resize(nodes+1);
+    r.seen.resize(nodes+1, 0);
+  }
+  if (++r.search == 0) {
+    std::fill(r.seen.begin(), r.seen.end(), 0);
+    r.search = 1;
+  }
+  r.open.clear();
+  auto relax = [](int x,float d,int prev,int via) {
+    if (r.seen[x] != r.search || d < r.dist[x]) {
+      r.seen[x] = r.search;
+      r.dist[x] = d;
+      r.prev[x] = prev;
+      r.via[x] = via;
+      r.open.push_back(std::make_pair(-d, x));
+      std::push_heap(r.open.begin(), r.open.end());
+    }
+  };
+  for (int k = 0; k < ns; k++) {
+    relax(startNodes[k], startCosts[k], -1, -1);
+  }
+
+  //Dijkstra sur les intersections
+  bool found = false;
+  while (!r.open.empty()) {
+    std::pop_heap(r.open.begin(), r.open.end());
+    float d = -r.open.back().first;
+    int x = r.open.back().second;
+    r.open.pop_back();
+    if (d > r.dist[x]) {
+      continue;
+    }
+    if (x == target) {
+      found = true;
+      break;
+    }
+    for (int e = edgeBegin[x]; e < edgeBegin[x+1]; e++) {
+      if (open[e].load(std::memory_order_relaxed)) {
+        relax(edges[e].to, d + edges[e].cost, x, e);
+      }
+    }
+    for (int k = 0; k < ng; k++) {
+      if (goalNodes[k] == x) {
+        relax(target, d + goalCosts[k], x, -1);
+      }
+    }
+  }
+  if (!found) {
+    return Pathfinder::local().findPath(grid, start, goal, tiles, landmarks);
+  }
+
+  r.chain.clear();
+  int last = r.prev[target];
+  int first = last;
+  while (r.via[first] != -1) {
+    r.chain.push_back(r.via[first]);
+    first = r.prev[first];
+  }
+
+  //on développe le début et la fin en tiles, le milieu est déjà calculé
+  if (!Pathfinder::local().findPath(grid, start, centers[first], tiles, landmarks)) {
+    return Pathfinder::local().findPath(grid, start, goal, tiles, landmarks);
+  }
+  for (int k = (int) r.chain.size()-1; k >= 0; k--) {
+    const Edge& e = edges[r.chain[k]];
+    tiles.insert(tiles.end(), waypoints.begin()+e.first, waypoints.begin()+e.first+e.count);
+    tiles.push_back(centers[e.to]);
+  }
+  if (!Pathfinder::local().findPath(grid, centers[last], goal, r.leg, landmarks)) {
+    return Pathfinder::local().findPath(grid, start, goal, tiles, landmarks);
+  }
+  tiles.insert(tiles.end(), r.leg.begin()+1, r.leg.end());
+  return true;
+}
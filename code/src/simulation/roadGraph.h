@@ -0,0 +1,99 @@
+#ifndef ROAD_GRAPH_H
+#define ROAD_GRAPH_H
+
+#include <vector>
+#include <atomic>
+
+class Geography;
+class NavGrid;
+class Landmarks;
+
+/**
+ * @brief The RoadGraph class
+ * the road network of a map, seen from above : the intersections (blocks of
+ * INTER tiles) are the nodes, and the road segments (blocks of ROADH or
+ * ROADV tiles) joining two intersections are the edges, weighted by the
+ * length of the tile path between the centres of the intersections.
+ *
+ * A route is searched in this small graph, then expanded into tiles : a tile
+ * A* is only run from the start to the first intersection and from the last
+ * intersection to the goal, the middle of the route being made of the paths
+ * computed once for the edges. Routes are thus close to, but not always
+ * exactly, the shortest ones.
+ * Starts and goals off the network, or too close to each other for the
+ * graph to help, are left to a plain tile A*.
+ * When tiles are blocked, the edges whose path crosses them are closed
+ * (see refresh) ; the other threads can go on searching meanwhile.
+ */
+class RoadGraph {
+ public:
+  /**
+   * @brief RoadGraph
+   * finds the intersections and segments of the map and the paths between
+   * neighbouring intersections
+   */
+  RoadGraph(Geography& map,const NavGrid& grid);
+
+  /**
+   * @brief findRoute
+   * computes a route between two tiles
+   * @param grid : the grid the graph was built on
+   * @param start : the id of the first tile
+   * @param goal : the id of the last tile
+   * @param tiles : filled with the ids of tiles to go through in order, start
+   * and goal included ; two consecutive tiles are joined by a straight line
+   * along a row or a column of walkable tiles
+   * @param landmarks : the landmarks of the grid for the tile A*, or nullptr
+   * @return true iff goal can be reached from start
+   */
+  bool findRoute(const NavGrid& grid,int start,int goal,std::vector<int>& tiles,
+                 const Landmarks* landmarks = nullptr) const;
+
+  int getIntersectionCount() const {
+    return (int) centers.size();
+  }
+
+  int getSegmentCount() const {
+    return (int) segmentBegin.size() - 1;
+  }
+
+  /**
+   * @brief refresh
+   * closes the edges whose path crosses a blocked tile of the grid, and opens
+   * the other ones again ; to be called when tiles have been (un)blocked
+   * @return the number of closed edges
+   */
+  int refresh(const NavGrid& grid);
+
+ private:
+  struct Edge {
+    int to;
+    float cost;
+    int first; // le chemin est dans waypoints, de first à first+count exclu
+    int count;
+  };
+
+  std::vector<int> intersectionOf; // per tile, -1 if not an INTER tile
+  std::vector<int> segmentOf;      // per tile, -1 if not a ROADH/ROADV tile
+  std::vector<int> centers;        // the central tile of each intersection
+
+  /* les intersections touchées par le segment k : ends[segmentBegin[k]..segmentBegin[k+1][ */
+  std::vector<int> segmentBegin;
+  std::vector<int> ends;
+
+  /* les arêtes partant de l'intersection k : edges[edgeBegin[k]..edgeBegin[k+1][ */
+  std::vector<int> edgeBegin;
+  std::vector<Edge> edges;
+  std::vector<std::atomic<bool>> open; // per edge, false if its path is blocked
+  std::vector<int> waypoints;
+
+  /**
+   * @brief link
+   * collects the intersections a tile is in or leads to, with the distance
+   * to their centres
+   * @return the number of intersections found (at most 4)
+   */
+  int link(const NavGrid& grid,int tile,int nodes[4],float costs[4]) const;
+};
+
+#endif // ROAD_GRAPH_H
@@ -0,0 +1,84 @@
+#include "routeCache.h"
+
+
+RouteCache::RouteCache(int capacity) : capacity(capacity), hits(0), misses(0), generation(0) {
+}
+
+
+RouteCache::Route RouteCache::find(int start,int goal) {
+  std::lock_guard<std::mutex> guard(lock);
+  auto found = byKey.find(key(start,goal));
+  if (found == byKey.end()) {
+    misses++;
+    return Route();
+  }
+  hits++;
+  //il redevient le plus récent
+  entries.splice(entries.begin(), entries, found->second);
+  return found->second->second;
+}
+
+
+void RouteCache::insert(int start,int goal,Route route,unsigned int since) {
+  std::lock_guard<std::mutex> guard(lock);
+  //calculée sur une carte qui a changé depuis
+  if (since != generation) {
+    return;
+  }
+  long long k = key(start,goal);
+  auto found = byKey.find(k);
+  if (found != byKey.end()) {
+    found->second->second = route;
+    entries.splice(entries.begin(), entries, found->second);
+    return;
+  }
+  entries.push_front(Entry(k, route));
+  byKey[k] = entries.begin();
+  shrink();
+  return;
+}
+
+
+void RouteCache::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+  entries.clear();
+  byKey.clear();
+  generation++;
+  return;
+}
+
+
+void RouteCache::setCapacity(int c) {
+  std::lock_guard<std::mutex> guard(lock);
+  capacity = c;
+  shrink();
+  return;
+}
+
+
+int RouteCache::getSize() {
+  std::lock_guard<std::mutex> guard(lock);
+  return (int) entries.size();
+}
+
+
+float RouteCache::getHitRate() const {
+  long long h = hits, m = misses;
+  return h + m > 0 ? (float) h / (h + m) : 0;
+}
+
+
+void RouteCache::resetCounters() {
+  hits = 0;
+  misses = 0;
+  return;
+}
+
+
+void RouteCache::shrink() {
+  while ((int) entries.size() > capacity && !entries.empty()) {
+    byKey.erase(entries.back().first);
+    entries.pop_back();
+  }
+  return;
+}
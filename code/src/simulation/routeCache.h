@@ -0,0 +1,116 @@
+#ifndef ROUTE_CACHE_H
+#define ROUTE_CACHE_H
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <atomic>
+
+/**
+ * @brief The RouteCache class
+ * the last routes computed, by (start tile, goal tile), so that NPCs leaving
+ * the same places for the same destinations share one computation.
+ * A route is the list of tiles where it turns (see RoadGraph::findRoute),
+ * without the random offset of each NPC, which Trajectory::followPath adds.
+ * It is shared by all the Trajectories following it and never modified.
+ * When the cache is full, the least recently used route is dropped.
+ * The cache can be used from several threads. Each clear starts a new
+ * generation, so that a route computed before it is not inserted after it.
+ */
+class RouteCache {
+ public:
+  typedef std::shared_ptr<const std::vector<int>> Route;
+
+  /**
+   * @brief RouteCache
+   * @param capacity : the maximal number of routes kept
+   */
+  explicit RouteCache(int capacity = 4096);
+  RouteCache(RouteCache&) = delete;
+
+  /**
+   * @brief find
+   * @return the route from start to goal if it is known, and null otherwise
+   */
+  Route find(int start,int goal);
+
+  /**
+   * @brief insert
+   * stores the route from start to goal, dropping the oldest one if needed
+   * @param since : the generation read before computing the route ; nothing
+   * is stored if the cache has been cleared since
+   */
+  void insert(int start,int goal,Route route,unsigned int since);
+
+  /**
+   * @brief clear
+   * forgets every route, to be called when the walkability of tiles has
+   * changed
+   */
+  void clear();
+
+  /**
+   * @brief getGeneration
+   * @return the number of calls to clear
+   */
+  unsigned int getGeneration() const {
+    return generation;
+  }
+
+  void setCapacity(int capacity);
+
+  int getCapacity() const {
+    return capacity;
+  }
+
+  int getSize();
+
+  /**
+   * @brief getHits
+   * @return the number of calls to find which found a route
+   */
+  long long getHits() const {
+    return hits;
+  }
+
+  /**
+   * @brief getMisses
+   * @return the number of calls to find which found nothing
+   */
+  long long getMisses() const {
+    return misses;
+  }
+
+  /**
+   * @brief getHitRate
+   * @return the share of the calls to find which found a route
+   */
+  float getHitRate() const;
+
+  /**
+   * @brief resetCounters
+   * sets the hits and misses back to 0
+   */
+  void resetCounters();
+
+ private:
+  typedef std::pair<long long,Route> Entry;
+
+  std::mutex lock;
+  int capacity;
+  std::list<Entry> entries; // du plus récent au plus ancien
+  std::unordered_map<long long,std::list<Entry>::iterator> byKey;
+  std::atomic<long long> hits;
+  std::atomic<long long> misses;
+  std::atomic<unsigned int> generation;
+
+  static long long key(int start,int goal) {
+    return ((long long) start << 32) | (unsigned int) goal;
+  }
+
+  void shrink();
+};
+
+#endif // ROUTE_CACHE_H
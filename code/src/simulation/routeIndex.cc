@@ -0,0 +1,124 @@
+#include "routeIndex.h"
+#include <algorithm>
+
+
+RouteIndex::RouteIndex() : width(0), height(0), count(0), stamp(0) {
+}
+
+
+void RouteIndex::reset(int w, int h) {
+  width = (w + CELL-1) / CELL;
+  height = (h + CELL-1) / CELL;
+  count = 0;
+  cells.assign(width*height, std::vector<NpcHandle>());
+  cellsOf.clear();
+  owners.clear();
+  seen.clear();
+  return;
+}
+
+
+int RouteIndex::cellOf(float x, float y) const {
+  int i = std::min(std::max((int) x / CELL, 0), width-1);
+  int j = std::min(std::max((int) y / CELL, 0), height-1);
+  return i*height + j;
+}
+
+
+void RouteIndex::update(NpcHandle npc, const std::vector<Position>& path) {
+  if (npc.isNull() || width == 0) {
+    return;
+  }
+  //l'emplacement a pu changer de NPC : on oublie celui qui y était indexé
+  if (npc.slot < cellsOf.size()) {
+    clearSlot(npc.slot);
+  } else {
+    cellsOf.resize(npc.slot+1);
+    owners.resize(npc.slot+1);
+    seen.resize(npc.slot+1, 0);
+  }
+  if (path.empty()) {
+    return;
+  }
+  std::vector<int>& mine = cellsOf[npc.slot];
+  auto q = path.begin();
+  auto p = q++;
+  for (; q != path.end(); p = q++) {
+    int a = cellOf(p->getX(), p->getY());
+    int b = cellOf(q->getX(), q->getY());
+    int i0 = std::min(a / height, b / height), i1 = std::max(a / height, b / height);
+    int j0 = std::min(a % height, b % height), j1 = std::max(a % height, b % height);
+    for (int i = i0; i <= i1; i++) {
+      for (int j = j0; j <= j1; j++) {
+        mine.push_back(i*height + j);
+      }
+    }
+  }
+  //les étapes successives se touchent : chaque bloc n'est gardé qu'une fois
+  std::sort(mine.begin(), mine.end());
+  mine.erase(std::unique(mine.begin(), mine.end()), mine.end());
+  for (int c : mine) {
+    cells[c].push_back(npc);
+  }
+  owners[npc.slot] = npc;
+  count++;
+  return;
+}
+
+
+void RouteIndex::remove(NpcHandle npc) {
+  if (!npc.isNull() && npc.slot < cellsOf.size() && owners[npc.slot] == npc) {
+    clearSlot(npc.slot);
+  }
+  return;
+}
+
+
+void RouteIndex::clearSlot(unsigned int slot) {
+  NpcHandle old = owners[slot];
+  if (old.isNull()) {
+    return;
+  }
+  for (int c : cellsOf[slot]) {
+    std::vector<NpcHandle>& cell = cells[c];
+    for (unsigned int k = 0; k < cell.size(); k++) {
+      if (cell[k] == old) {
+        cell[k] = cell.back();
+        cell.pop_back();
+        break;
+      }
+    }
+  }
+  cellsOf[slot].clear();
+  owners[slot] = NpcHandle();
+  count--;
+  return;
+}
+
+
+void RouteIndex::collect(const std::vector<std::pair<int,int>>& tiles, std::vector<NpcHandle>& out) {
+  out.clear();
+  if (width == 0) {
+    return;
+  }
+  stamp++;
+  if (stamp == 0) {
+    std::fill(seen.begin(), seen.end(), 0);
+    stamp = 1;
+  }
+  std::vector<int> blocks;
+  for (const std::pair<int,int>& t : tiles) {
+    blocks.push_back(cellOf(t.first, t.second));
+  }
+  std::sort(blocks.begin(), blocks.end());
+  blocks.erase(std::unique(blocks.begin(), blocks.end()), blocks.end());
+  for (int c : blocks) {
+    for (NpcHandle npc : cells[c]) {
+      if (seen[npc.slot] != stamp) {
+        seen[npc.slot] = stamp;
+        out.push_back(npc);
+      }
+    }
+  }
+  return;
+}
@@ -0,0 +1,89 @@
+#ifndef ROUTE_INDEX_H
+#define ROUTE_INDEX_H
+
+#include <vector>
+#include <utility>
+#include "npcStore.h"
+#include "position.h"
+
+/**
+ * @brief The RouteIndex class
+ * for every block of CELL x CELL tiles, the handles of the NPCs whose
+ * remaining path crosses it, so that when tiles are blocked only the paths
+ * of these NPCs are checked and repaired (see Simulation::setBlocked).
+ * A path is indexed by the blocks covered by each of its legs, the rectangle
+ * of blocks around the leg (a strip when it runs along a row or a column).
+ * The index thus gives a few NPCs too many, never too few.
+ * It is used by the simulation thread only.
+ */
+class RouteIndex {
+ public:
+  /* side of a block, in tiles */
+  static const int CELL = 8;
+
+  /**
+   * @brief RouteIndex
+   * creates an empty index of size 0x0, use reset before indexing anything
+   */
+  RouteIndex();
+
+  /**
+   * @brief reset
+   * empties the index and resizes it
+   * @param width : the map width in tiles
+   * @param height : the map height in tiles
+   */
+  void reset(int width, int height);
+
+  /**
+   * @brief update
+   * forgets the previous path of a NPC and indexes the new one
+   * @param npc : the NPC
+   * @param path : his current position then his waypoints, see Trajectory::getWaypoints
+   */
+  void update(NpcHandle npc, const std::vector<Position>& path);
+
+  /**
+   * @brief remove
+   * forgets the path of a NPC
+   */
+  void remove(NpcHandle npc);
+
+  /**
+   * @brief collect
+   * gives the NPCs whose path may cross one of the tiles, each once
+   * @param tiles : the coordinates of the tiles
+   * @param out : filled with the handles of the NPCs
+   */
+  void collect(const std::vector<std::pair<int,int>>& tiles, std::vector<NpcHandle>& out);
+
+  /**
+   * @brief size
+   * @return the number of NPCs indexed
+   */
+  int size() const {
+    return count;
+  }
+
+ private:
+  int width;     // in blocks
+  int height;
+  int count;
+  std::vector<std::vector<NpcHandle>> cells;
+  /* les blocs du chemin du NPC de chaque emplacement du NpcStore */
+  std::vector<std::vector<int>> cellsOf;
+  std::vector<NpcHandle> owners;
+  /* pour ne donner chaque NPC qu'une fois dans collect */
+  std::vector<unsigned int> seen;
+  unsigned int stamp;
+
+  int cellOf(float x, float y) const;
+
+  /**
+   * @brief clearSlot
+   * forgets the path of the NPC indexed in a slot, if any
+   */
+  void clearSlot(unsigned int slot);
+};
+
+#endif // ROUTE_INDEX_H
@@ -5,8 +5,11 @@
 #include "../graphism/graphic_context_iso.h"
 #include "../generation/geography.h"
 #include "../generation/tile.h"
+#include "../generation/navGrid.h"
+#include "flowField.h"
 #include "npc.h"
 #include <cstdlib>
+#include <algorithm>
 #include <iostream>
 #include "position.h"
 #include "generation/generation1.h"
@@ -21,7 +24,7 @@
 #include "debug.h"
 
 Simulation::Simulation(int nbPlayers, int id) :
-		scenario(NULL), isServer(false) {
+		scenario(NULL), isServer(false), workers(new ThreadPool()), paths(new PathService()) {
 	this->NB_JOUEURS = nbPlayers;
 	this->Id = id;
 
@@ -29,19 +32,14 @@ Simulation::Simulation(int nbPlayers, int id) :
 	this->sous = std::vector<int>(NB_JOUEURS, 0);
 	this->relativeTime = 0;
 	this->absoluteTime = 0;
-	this->smallTime = 0;
 
 	DBG << (this->getMap());
 	Tile* firstTile = (this->getMap())->getWalkableTile();
 	addPlayer(id, firstTile->getCoord().getAbs(), firstTile->getCoord().getOrd());
-
-	tmp = std::vector<std::vector<int> >(getMap()->getMapWidth() + 1);
-	for (int i = 0; i < getMap()->getMapWidth() + 1; ++i)
-		tmp[i] = std::vector<int>(getMap()->getMapWidth() + 1, 0);
 }
 
 Simulation::Simulation(Geography* map, int nbPlayers, int id) :
-		scenario(NULL), isServer(false) {
+		scenario(NULL), isServer(false), workers(new ThreadPool()), paths(new PathService()) {
 	this->setGeography(map);
 	this->NB_JOUEURS = nbPlayers;
 	this->Id = id;
@@ -50,22 +48,18 @@ Simulation::Simulation(Geography* map, int nbPlayers, int id) :
 	this->sous = std::vector<int>(NB_JOUEURS, 200);
 	this->relativeTime = 0;
 	this->absoluteTime = 0;
-	this->smallTime = 0;
 
 	DBG << (this->getMap());
 	Tile* firstTile = (this->getMap())->getWalkableTile();
 	addPlayer(id, firstTile->getCoord().getAbs(), firstTile->getCoord().getOrd());
-	tmp = std::vector<std::vector<int> >(getMap()->getMapWidth() + 1);
-	for (int i = 0; i < getMap()->getMapWidth() + 1; ++i)
-		tmp[i] = std::vector<int>(getMap()->getMapWidth() + 1, 0);
 }
 
 Simulation::~Simulation() {
 
-	for (auto& pair : NPCs) {
-		delete pair.second;
+	for (int i = 0; i < npcs.size(); i++) {
+		delete npcs.getObject(i);
 	}
-	NPCs.clear();
+	npcs.clear();
 	for (auto& e : pendingActions) {
 		delete e;
 	}
@@ -120,24 +114,13 @@ void Simulation::deleteAction(Action* a) {
 	return;
 }
 
-//Simplement des casts en float de pow, sqrt et floor
-float pow2(float x, float y) {
-	return ((float) (pow((double(x)), double(y))));
-}
-
-float sqrt2(float x) {
-	return ((float) (sqrt((double) x)));
-}
-
-float floor2(float x) {
-	return ((float) (floor((double(x)))));
-}
-
 void Simulation::addNPC(NPC* npc) {
   //on l'ajoute à la liste
-  NPCs.insert( { npc->getUuid(), npc });
+  NpcHandle handle = npcs.add(npc);
   //on le met dans sa tile de départ
-  npc->getPosition().isInTile(*map).addNPC(npc);
+  Tile& tile = npc->getPosition().isInTile(*map);
+  tile.addNPC(npc);
+  npcIndex.insert(handle, tile.getCoord().getAbs(), tile.getCoord().getOrd());
   trigger("NPC::created", *npc);
 }
 
@@ -150,15 +133,18 @@ NPC* Simulation::buildNPC(Position start, Position target, float speed,
                           TexturePack* tex, boost::uuids::uuid uuid /*optional*/) {
   NPC* npc = new NPC(speed, 10, 1.5, start, tex, uuid);
   //on calcule son mouvement
-  npc->setTarget(target, *map);
+  routeNPC(*npc, target);
   return npc;
 }
 
 void Simulation::supprimerNPC(NPC * npc) {
 	//on le retire de sa tile
-	npc->getPosition().isInTile(*map).removeNPC(npc);
+	Tile& tile = npc->getPosition().isInTile(*map);
+	tile.removeNPC(npc);
+	npcIndex.remove(npc->getHandle(), tile.getCoord().getAbs(), tile.getCoord().getOrd());
+	routes.remove(npc->getHandle());
 	//on le retire de la liste
-	NPCs.erase(npc->getUuid());
+	npcs.remove(npc->getHandle());
 	//on le supprime
 	delete npc;
 	return;
@@ -169,8 +155,10 @@ void Simulation::supprimerNPCDansCase(int i, int j) {
 	NPC *npc = map->getTileRef(i, j).getNPCs().front();
 	//on le supprime de la tile
 	map->getTileRef(i, j).removeNPC(npc);
+	npcIndex.remove(npc->getHandle(), i, j);
+	routes.remove(npc->getHandle());
 	//on le supprime de la liste
-	NPCs.erase(npc->getUuid());
+	npcs.remove(npc->getHandle());
 	return;
 }
 
@@ -216,148 +204,106 @@ void Simulation::reroute(NPC& npc) {
 		x = rand() % MAP_SIZE;
 		y = rand() % MAP_SIZE;
 	}
-	npc.setTarget(Position(x, y), *(this->map));
+	routeNPC(npc, Position(x, y));
 	return;
 }
 
-void Simulation::copyTmp() {
-	for (int i = 0; i < 100; i++) {
-		for (int j = 0; j < 100; j++) {
-			tmp[i][j] = this->map->getAnxiety(i, j);
-		}
-	}
+void Simulation::routeNPC(NPC& npc, Position target) {
+	npc.headTowards(target);
+	routes.remove(npc.getHandle());
+	const NavGrid& grid = map->getNavGrid();
+	std::pair<int, int> start = npc.getPosition().isInTile();
+	std::pair<int, int> goal = target.isInTile();
+	boost::uuids::uuid id = npc.getUuid();
+	unsigned int generation = map->getRouteCache().getGeneration();
+	paths->request(*map, grid.getId(start.first, start.second),
+			grid.getId(goal.first, goal.second),
+			[this, id, target, generation](const RouteCache::Route& route) {
+				NpcHandle h = npcs.find(id);
+				NPC* npc = npcs.get(h);
+				//le NPC a pu disparaître ou changer de cible entre-temps
+				if (npc == nullptr || !npc->getTarget().equal(target)) {
+					return;
+				}
+				if (!route) {
+					LOG(info) << "routeNPC : no path to " << target.getX() << " " << target.getY();
+					return;
+				}
+				npc->followPath(route, map->getNavGrid());
+				//des tiles ont été bloquées pendant le calcul
+				if (map->getRouteCache().getGeneration() != generation && !npc->repairPath(*map)) {
+					routeNPC(*npc, target);
+					return;
+				}
+				std::vector<Position> points;
+				npc->getTrajectory().getWaypoints(points);
+				routes.update(h, points);
+			});
+	profiler.count(TickProfiler::PATHFINDING_CALLS);
+	return;
 }
 
-/**
- * @brief Simulation::lisserMatrice : Nivelle la peur via une sorte de norme 2
- */
-void Simulation::lisserMatrice() {
-	float anxiety;
-
-	//on met les valeurs courantes de la geography dans une matrice de chiffres (attribut de simulation)
-	this->copyTmp();
-
-	//interieur de la map
-	for (int i = 1; i < MAP_SIZE - 2; i++) {
-		for (int j = 1; j < MAP_SIZE - 2; j++) {
-			//calcul
-			//set
-			//Pour l'instant ça pour tester
-			anxiety = ((5 * tmp[i][j]) + tmp[i - 1][j] + tmp[i + 1][j]
-					+ tmp[i][j - 1] + tmp[i][j + 1]) / 9;
-			map->setAnxiety(i, j, anxiety);
-		}
+void Simulation::applyRoutes() {
+	paths->poll();
+	return;
+}
+
+int Simulation::setBlocked(const std::vector<std::pair<int, int> >& tiles, bool blocked) {
+	int changed = map->setBlocked(tiles, blocked);
+	//débloquer ne coupe aucun chemin
+	if (changed == 0 || !blocked) {
+		return changed;
 	}
-	DBG << "Simulation :fin du centre";
-
-	//bande en bas (i=0)
-	for (int j = 1; j < MAP_SIZE - 2; j++) {
-		//calcul
-		anxiety = sqrt2(
-				(1 / 6)
-						* (2 * pow2(tmp[0][j], 2) + pow2(tmp[0][j - 1], 2)
-								+ pow2(tmp[1][j], 2) + pow2(tmp[0][j + 1], 2)
-								+ (1 / 2)
-										* (pow2(tmp[1][j + 1], 2)
-												+ pow2(tmp[1][j - 1], 2))));
-		//set
-		map->setAnxiety(0, j, anxiety);
+	std::vector<NpcHandle> crossing;
+	std::vector<Position> points;
+	routes.collect(tiles, crossing);
+	for (NpcHandle h : crossing) {
+		NPC* npc = npcs.get(h);
+		if (npc == nullptr) {
+			routes.remove(h);
+			continue;
+		}
+		profiler.count(TickProfiler::ROUTES_CHECKED);
+		if (npc->repairPath(*map)) {
+			npc->getTrajectory().getWaypoints(points);
+			routes.update(h, points);
+		} else {
+			routeNPC(*npc, npc->getTarget());
+		}
 	}
+	return changed;
+}
 
-	//bande à gauche (j=0)
-	for (int i = 1; i < MAP_SIZE - 2; i++) {
-		//calcul
-		anxiety = sqrt2(
-				(1 / 6)
-						* (2 * pow2(tmp[i][0], 2) + pow2(tmp[i - 1][0], 2)
-								+ pow2(tmp[i + 1][0], 2)
-								+ pow2(tmp[i][0 + 1], 2)
-								+ (1 / 2)
-										* (pow2(tmp[i - 1][1], 2)
-												+ pow2(tmp[i + 1][1], 2))));
-		//set
-		map->setAnxiety(i, 0, anxiety);
+void Simulation::evacuateNPC(NPC& npc) {
+	routes.remove(npc.getHandle());
+	if (!npc.followField(getExitField())) {
+		reroute(npc);
 	}
-	DBG << "Simulation :fin de la bande gauche";
-
-	//bande à droite (j=MAP_SIZE -1)
-	for (int i = 1; i < MAP_SIZE - 2; i++) {
-		//calcul
-		anxiety = sqrt2(
-				(1 / 6)
-						* (2 * pow2(tmp[i][MAP_SIZE - 1], 2)
-								+ pow2(tmp[i - 1][MAP_SIZE - 1], 2)
-								+ pow2(tmp[i + 1][MAP_SIZE - 1], 2)
-								+ pow2(tmp[i][MAP_SIZE - 1 - 1], 2)
-								+ (1 / 2)
-										* (pow2(tmp[i - 1][MAP_SIZE - 1 - 1], 2)
-												+ pow2(
-														tmp[i + 1][MAP_SIZE - 1
-																- 1], 2))));
-		//set
-		map->setAnxiety(i, MAP_SIZE - 1, anxiety);
-	}
-	DBG << "Simulation :fin de la bande droite";
-	//bande en haut (i=MAP_SIZE -1)
-	for (int j = 1; j < MAP_SIZE - 2; j++) {
-		//calcul
-		anxiety = sqrt2(
-				(1 / 6)
-						* (2 * pow2(tmp[MAP_SIZE - 1][j], 2)
-								+ pow2(tmp[MAP_SIZE - 2][j], 2)
-								+ pow2(tmp[MAP_SIZE - 1][j - 1], 2)
-								+ pow2(tmp[MAP_SIZE - 1][j + 1], 2)
-								+ (1 / 2)
-										* (pow2(tmp[MAP_SIZE - 2][j + 1], 2)
-												+ pow2(tmp[MAP_SIZE - 2][j - 1],
-														2))));
-		//set
-		map->setAnxiety(MAP_SIZE - 1, j, anxiety);
+	return;
+}
+
+std::shared_ptr<const FlowField> Simulation::getExitField() {
+	if (exits.empty()) {
+		const NavGrid& grid = map->getNavGrid();
+		for (int i = 0; i < grid.getWidth(); i++) {
+			for (int j = 0; j < grid.getHeight(); j++) {
+				bool border = i == 0 || j == 0 || i == grid.getWidth()-1 || j == grid.getHeight()-1;
+				if (border && grid.getMoves(grid.getId(i, j)) != 0) {
+					exits.push_back(grid.getId(i, j));
+				}
+			}
+		}
 	}
-	DBG << "Simulation :fin de la bande en haut";
-
-	//coin en haut à gauche
-	anxiety = sqrt2(
-			(1 / 4.5)
-					* (2 * pow2(tmp[0][MAP_SIZE - 1], 2)
-							+ pow2(tmp[0][MAP_SIZE - 2], 2)
-							+ pow2(tmp[1][MAP_SIZE - 1], 2)
-							+ (1 / 2) * pow2(tmp[1][MAP_SIZE - 2], 2)));
-	map->setAnxiety(0, MAP_SIZE - 1, anxiety);
-
-	//coin en haut à droite
-	anxiety =
-			sqrt2(
-					(1 / 4.5)
-							* (2 * pow2(tmp[MAP_SIZE - 1][MAP_SIZE - 1], 2)
-									+ pow2(tmp[MAP_SIZE - 1][MAP_SIZE - 2], 2)
-									+ pow2(tmp[MAP_SIZE - 2][MAP_SIZE - 1], 2)
-									+ (1 / 2)
-											* (pow2(
-													tmp[MAP_SIZE - 2][MAP_SIZE
-															- 2], 2))));
-	map->setAnxiety(MAP_SIZE - 1, MAP_SIZE - 1, anxiety);
-
-	//coin en bas à gauche
-	anxiety =
-			sqrt2(
-					(1 / 4.5)
-							* (2 * pow2(tmp[0][0], 2) + pow2(tmp[0][1], 2)
-									+ pow2(tmp[1][0], 2)
-									+ (1 / 2) * pow2(tmp[1][1], 2)));
-	map->setAnxiety(0, 0, anxiety);
-
-	//coin en bas à droite
-	anxiety = sqrt2(
-			(1 / 4.5)
-					* (2 * pow2(tmp[MAP_SIZE - 1][0], 2)
-							+ pow2(tmp[MAP_SIZE - 1][1], 2)
-							+ pow2(tmp[MAP_SIZE - 2][0], 2)
-							+ (1 / 2) * (pow2(tmp[MAP_SIZE - 2][1], 2))));
-	map->setAnxiety(MAP_SIZE - 1, 0, anxiety);
-
-	DBG << "fin de tout";
-	DBG << "fin du dl";
+	return map->getFlowField(exits);
+}
+
+/**
+ * @brief Simulation::lisserMatrice : Nivelle la peur, en diffusant le champ
+ * d'anxiété puis en le recopiant dans les cases de la carte
+ */
+void Simulation::lisserMatrice(float dt) {
+	anxiety.diffuse(dt, *workers);
+	anxiety.store(*map);
 	return;
 }
 
@@ -385,6 +331,12 @@ void Simulation::setGeography(Geography *g) {
 	map = g;
 	if (map) {
 		MAP_SIZE = map->getMapWidth();
+		npcIndex.reset(map->getMapWidth(), map->getMapHeight());
+		routes.reset(map->getMapWidth(), map->getMapHeight());
+		exits.clear();
+		anxiety.load(*map);
+		//les premiers calculs de trajectoire n'auront pas à le faire
+		map->getRoadGraph();
 	}
 	return;
 }
@@ -395,6 +347,71 @@ void Simulation::setScenario(HScenario* s) {
 }
 
 NPC* Simulation::getNPCByID(boost::uuids::uuid uuid) {
-	auto iterator = NPCs.find(uuid);
-	return (iterator == NPCs.end()) ? nullptr : (iterator->second);
+	return npcs.get(npcs.find(uuid));
+}
+
+NpcStore& Simulation::getNPCStore() {
+	return npcs;
+}
+
+const SpatialIndex& Simulation::getSpatialIndex() const {
+	return npcIndex;
+}
+
+AnxietyField& Simulation::getAnxietyField() {
+	return anxiety;
+}
+
+void Simulation::raiseAnxiety(int i, int j, float amount) {
+	if (!map->isInTheMap(i, j)) {
+		return;
+	}
+	anxiety.set(i, j, std::min(100.f, anxiety.get(i, j) + amount));
+	return;
+}
+
+TickProfiler& Simulation::getProfiler() {
+	return profiler;
+}
+
+TickScheduler& Simulation::getScheduler() {
+	return scheduler;
+}
+
+PathService& Simulation::getPathService() {
+	return *paths;
+}
+
+ThreadPool& Simulation::getWorkers() {
+	return *workers;
+}
+
+void Simulation::setThreadCount(int threads) {
+	workers.reset(new ThreadPool(threads));
+	return;
+}
+
+void Simulation::moveNPC(NPC* npc, Tile& tileBefore, Tile& tileAfter) {
+	/*
+	 * To listen with class C, derive EventListener<C> and then:
+	 *
+	 *   listen("NPC::changedTile",someNPC,&C::someMethod);
+	 *
+	 *   with someNPC a reference to the actual stored NPC
+	 *   and someMethod(NPC& npc, std::pair<Tile,Tile> tilePair)
+	 *   tilePair.first will be tileBefore
+	 *   tilePair.second will be tileAfter
+	 *
+	 * To stop listening later:
+	 *
+	 *   unlisten("NPC::changedTile",someNPC);
+	 */
+	npc->trigger("NPC::changedTile",
+			std::pair<Tile, Tile>(tileBefore, tileAfter));
+	tileBefore.removeNPC(npc);
+	tileAfter.addNPC(npc);
+	npcIndex.move(npc->getHandle(), tileBefore.getCoord().getAbs(), tileBefore.getCoord().getOrd(),
+			tileAfter.getCoord().getAbs(), tileAfter.getCoord().getOrd());
+	profiler.count(TickProfiler::TILE_CHANGES);
+	return;
 }
@@ -24,6 +24,15 @@ class GraphicContextIso;
 #include "eventListener.h"
 #include "time.h"
 #include "player.h"
+#include "spatialIndex.h"
+#include "npcStore.h"
+#include "threadPool.h"
+#include "anxietyField.h"
+#include "tickScheduler.h"
+#include "tickProfiler.h"
+#include "pathService.h"
+#include "routeIndex.h"
+#include <memory>
 #include "../network/network.h"
 #include "../graphism/animation.h"
 
@@ -97,10 +106,54 @@ public:
    */
   void reroute(NPC& npc);
 
+  /**
+   * @brief routeNPC
+   * gives a new target to a NPC and asks the PathService for its path ; the
+   * NPC heads towards the target until the path is applied by applyRoutes
+   * @param npc : the NPC, which may not be in the simulation yet
+   * @param target : its new target
+   */
+  void routeNPC(NPC& npc, Position target);
+
+  /**
+   * @brief applyRoutes
+   * gives their paths to the NPCs whose routes have been computed, to be
+   * called once per tick
+   */
+  void applyRoutes();
+
+  /**
+   * @brief setBlocked
+   * blocks tiles, or unblocks them (see Geography::setBlocked), then repairs
+   * the paths of the NPCs crossing the newly blocked tiles : only the NPCs
+   * given by the RouteIndex are checked, and only the blocked stretch of
+   * their path is searched again, the whole path only if it cannot be
+   * avoided (see Trajectory::repairPath)
+   * @param tiles : the coordinates of the tiles
+   * @param blocked : true to block them, false to unblock them
+   * @return the number of tiles which changed
+   */
+  int setBlocked(const std::vector<std::pair<int,int>>& tiles, bool blocked);
+
+  /**
+   * @brief evacuateNPC
+   * makes a NPC run to the nearest exit of the map, the walkable tiles of its
+   * border, by following the flow field shared by all the fleeing NPCs ;
+   * if no exit can be reached, he is rerouted instead
+   * @param npc : the NPC
+   */
+  void evacuateNPC(NPC& npc);
+
+  /**
+   * @brief getExitField
+   * @return the flow field towards the exits of the map, see Geography::getFlowField
+   */
+  std::shared_ptr<const FlowField> getExitField();
+
   void setContextIso(GraphicContextIso* gra);
 
-  /*methode qui agit sur la matrice pour lisser la peur*/
-  virtual void lisserMatrice();
+  /*methode qui agit sur la matrice pour lisser la peur, dt en secondes*/
+  virtual void lisserMatrice(float dt);
   template <class T>
 
   T& getItemByID(int id);
@@ -138,21 +191,98 @@ public:
     * @return nullptr if NPC not found, a pointer to the NPC otherwise.
     */
    NPC* getNPCByID(boost::uuids::uuid uuid);
+
+   /**
+    * @brief getNPCStore
+    * @return the store of all the NPCs of the simulation
+    */
+   NpcStore& getNPCStore();
+
+   /**
+    * @brief getSpatialIndex
+    * @return the grid of the NPCs by tile, to look for the NPCs near a position
+    */
+   const SpatialIndex& getSpatialIndex() const;
+
+   /**
+    * @brief getAnxietyField
+    * @return the anxiety of the tiles, which the tiles of the map only mirror
+    */
+   AnxietyField& getAnxietyField();
+
+   /**
+    * @brief raiseAnxiety
+    * adds anxiety to a tile (up to 100), from where it spreads to the
+    * neighbourhood, see AnxietyField ; does nothing outside of the map
+    * @param i : abscissa of the tile
+    * @param j : ordinate of the tile
+    * @param amount : the anxiety to add
+    */
+   void raiseAnxiety(int i, int j, float amount);
+
+   /**
+    * @brief getScheduler
+    * @return the clock of the simulation : its tick rate and the number of
+    * ticks run, which the periodic tasks key off
+    */
+   TickScheduler& getScheduler();
+
+   /**
+    * @brief getProfiler
+    * @return the timings of the phases of run() and the counters of the
+    * current window, see TickProfiler
+    */
+   TickProfiler& getProfiler();
+
+   /**
+    * @brief getWorkers
+    * @return the threads used to move the NPCs
+    */
+   ThreadPool& getWorkers();
+
+   /**
+    * @brief setThreadCount
+    * @param threads : the number of threads moving the NPCs (0 for one per core)
+    */
+   void setThreadCount(int threads);
+
+   /**
+    * @brief getPathService
+    * @return the threads computing the paths of routeNPC
+    */
+   PathService& getPathService();
+
+   /**
+    * @brief forEachNPCInRadius
+    * calls visit(NPC*) for every NPC in the square of tiles [i-r,i+r]x[j-r,j+r]
+    */
+   template <typename Visitor>
+   void forEachNPCInRadius(int i, int j, int r, Visitor&& visit);
+
+   /**
+    * @brief forEachNPCInDiamond
+    * calls visit(NPC*) for every NPC at manhattan distance at most r of the tile (i,j)
+    */
+   template <typename Visitor>
+   void forEachNPCInDiamond(int i, int j, int r, Visitor&& visit);
+
+   /**
+    * @brief moveNPC
+    * to be called when a NPC has entered a new tile : triggers
+    * "NPC::changedTile" and moves the NPC in the tiles and the spatial index
+    * @param npc : the NPC which moved
+    * @param tileBefore : the tile the NPC was in
+    * @param tileAfter : the tile the NPC is now in
+    */
+   void moveNPC(NPC* npc, Tile& tileBefore, Tile& tileAfter);
 protected :
 
    //Pour pouvoir créer des npcs
    GraphicContextIso* graContIso;
 
-   void copyTmp();
    std::list<Camera*> cameras;
    std::list<Agent*> agents;
 
-   /**
-    * @brief tmp: used to copy only required information from *map to calculate
-    * fear (peur)
-    */
-   std::vector<std::vector<int> > tmp;
-
    HScenario* scenario;
    bool isServer;
    int MAP_SIZE;
@@ -170,10 +300,46 @@ protected :
 
    float absoluteTime;
    float relativeTime;
-   float smallTime;
    Geography* map;
    std::list<Player> players;
-   std::map<boost::uuids::uuid, NPC*> NPCs;
+   /**
+    * @brief npcs : the NPCs, their hot state stored by arrays
+    */
+   NpcStore npcs;
+   /**
+    * @brief npcIndex : the NPCs of npcs sorted by tile, for the neighbour queries
+    */
+   SpatialIndex npcIndex;
+   /**
+    * @brief anxiety : the anxiety of the tiles, see lisserMatrice
+    */
+   AnxietyField anxiety;
+   /**
+    * @brief scheduler : the fixed-length ticks of run()
+    */
+   TickScheduler scheduler;
+   /**
+    * @brief profiler : the timings and counters of run()
+    */
+   TickProfiler profiler;
+   /**
+    * @brief workers : the threads of the movement phase, behind a pointer so
+    * the Simulation stays movable
+    */
+   std::unique_ptr<ThreadPool> workers;
+   /**
+    * @brief paths : the routes being computed ; its callbacks refer to the
+    * Simulation, which must not be moved while routes are pending
+    */
+   std::unique_ptr<PathService> paths;
+   /**
+    * @brief routes : the NPCs by the tiles their path crosses, see setBlocked
+    */
+   RouteIndex routes;
+   /**
+    * @brief exits : the walkable tiles of the border of the map, see getExitField
+    */
+   std::vector<int> exits;
    std::list<ScenarioAction *> pendingActions;
    /**
     * @brief toDelete : liste des actions déjà traité
@@ -191,4 +357,18 @@ T& Simulation::getItemByID(int stuffID) {
   throw StuffNotFound();
 }
 
+template <typename Visitor>
+void Simulation::forEachNPCInRadius(int i, int j, int r, Visitor&& visit) {
+  npcIndex.forEachInRadius(i, j, r, [&](NpcHandle h) {
+    visit(npcs.get(h));
+  });
+}
+
+template <typename Visitor>
+void Simulation::forEachNPCInDiamond(int i, int j, int r, Visitor&& visit) {
+  npcIndex.forEachInDiamond(i, j, r, [&](NpcHandle h) {
+    visit(npcs.get(h));
+  });
+}
+
 #endif // SIMULATION_H
@@ -0,0 +1,214 @@
+#include "socialForce.h"
+#include <cmath>
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/* pas des différences finies, le même que Character::gradPot */
+static const float H = 0.01f;
+
+
+void NeighbourBatch::clear() {
+  x.clear(); y.clear();
+  xDeltaT.clear(); yDeltaT.clear();
+  c2.clear();
+  invLambda.clear();
+  Vzero.clear();
+  return;
+}
+
+
+void NeighbourBatch::push(float x,float y,float vx,float vy,float deltaT,float lambda,float Vzero) {
+  float c = 0.5f * sqrt(vx*vx+vy*vy) * deltaT;
+  this->x.push_back(x);
+  this->y.push_back(y);
+  xDeltaT.push_back(x + deltaT*vx);
+  yDeltaT.push_back(y + deltaT*vy);
+  c2.push_back(c*c);
+  invLambda.push_back(1/lambda);
+  this->Vzero.push_back(Vzero);
+  return;
+}
+
+
+/**
+ * @brief potential of the k-th Character of the batch at (px,py), see
+ * Character::potential (b = 0 inside the segment of the foci, as a <= c)
+ */
+static inline float potential(const NeighbourBatch& n,int k,float px,float py) {
+  float d1 = sqrt((px-n.x[k])*(px-n.x[k])+(py-n.y[k])*(py-n.y[k]));
+  float d2 = sqrt((px-n.xDeltaT[k])*(px-n.xDeltaT[k])+(py-n.yDeltaT[k])*(py-n.yDeltaT[k]));
+  float a = 0.5f * (d1+d2);
+  float b2 = a*a - n.c2[k];
+  float b = b2 > 0 ? sqrt(b2) : 0;
+  return n.Vzero[k]*exp(-b*n.invLambda[k]);
+}
+
+
+/**
+ * @brief sums the gradients of the Characters [first,last[ of the batch
+ */
+static void gradPotScalar(const NeighbourBatch& n,int first,int last,float px,float py,float& gx,float& gy) {
+  for (int k = first; k < last; k++) {
+    gx += (potential(n,k,px+H,py) - potential(n,k,px-H,py)) / (2*H);
+    gy += (potential(n,k,px,py+H) - potential(n,k,px,py-H)) / (2*H);
+  }
+  return;
+}
+
+
+/* exp vectorisé : réduction x = n*ln(2) + r puis polynôme de degré 5 sur r,
+ * comme l'expf de Cephes. Erreur relative de l'ordre de 1e-7 */
+static const float EXP_HI = 88.3762626647949f;
+static const float EXP_LO = -88.3762626647949f;
+static const float LOG2E = 1.44269504088896341f;
+static const float LN2_HI = 0.693359375f;
+static const float LN2_LO = -2.12194440e-4f;
+static const float P0 = 1.9875691500e-4f;
+static const float P1 = 1.3981999507e-3f;
+static const float P2 = 8.3334519073e-3f;
+static const float P3 = 4.1665795894e-2f;
+static const float P4 = 1.6666665459e-1f;
+static const float P5 = 5.0000001201e-1f;
+
+#if defined(__AVX2__)
+
+static inline __m256 exp8(__m256 x) {
+  x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(EXP_LO)), _mm256_set1_ps(EXP_HI));
+  __m256 fx = _mm256_floor_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(LOG2E)), _mm256_set1_ps(0.5f)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(LN2_HI)));
+  x = _mm256_sub_ps(x, _mm256_mul_ps(fx, _mm256_set1_ps(LN2_LO)));
+  __m256 x2 = _mm256_mul_ps(x, x);
+  __m256 y = _mm256_set1_ps(P0);
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(P1));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(P2));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(P3));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(P4));
+  y = _mm256_add_ps(_mm256_mul_ps(y, x), _mm256_set1_ps(P5));
+  y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, x2), x), _mm256_set1_ps(1.0f));
+  __m256i n = _mm256_add_epi32(_mm256_cvttps_epi32(fx), _mm256_set1_epi32(127));
+  return _mm256_mul_ps(y, _mm256_castsi256_ps(_mm256_slli_epi32(n, 23)));
+}
+
+static inline __m256 potential8(__m256 px,__m256 py,__m256 x,__m256 y,__m256 xd,__m256 yd,
+                                __m256 c2,__m256 invLambda,__m256 Vzero) {
+  __m256 dx1 = _mm256_sub_ps(px, x), dy1 = _mm256_sub_ps(py, y);
+  __m256 dx2 = _mm256_sub_ps(px, xd), dy2 = _mm256_sub_ps(py, yd);
+  __m256 d1 = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx1, dx1), _mm256_mul_ps(dy1, dy1)));
+  __m256 d2 = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx2, dx2), _mm256_mul_ps(dy2, dy2)));
+  __m256 a = _mm256_mul_ps(_mm256_set1_ps(0.5f), _mm256_add_ps(d1, d2));
+  __m256 b2 = _mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(a, a), c2), _mm256_setzero_ps());
+  __m256 b = _mm256_sqrt_ps(b2);
+  return _mm256_mul_ps(Vzero, exp8(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(b, invLambda))));
+}
+
+static inline float sum8(__m256 v) {
+  __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+std::pair<float,float> SocialForce::gradPot(float px,float py,const NeighbourBatch& n) {
+  const int count = n.size();
+  const __m256 pxp = _mm256_set1_ps(px+H), pxm = _mm256_set1_ps(px-H), pxv = _mm256_set1_ps(px);
+  const __m256 pyp = _mm256_set1_ps(py+H), pym = _mm256_set1_ps(py-H), pyv = _mm256_set1_ps(py);
+  __m256 gx = _mm256_setzero_ps(), gy = _mm256_setzero_ps();
+  int k = 0;
+  for (; k + 8 <= count; k += 8) {
+    __m256 x = _mm256_loadu_ps(&n.x[k]), y = _mm256_loadu_ps(&n.y[k]);
+    __m256 xd = _mm256_loadu_ps(&n.xDeltaT[k]), yd = _mm256_loadu_ps(&n.yDeltaT[k]);
+    __m256 c2 = _mm256_loadu_ps(&n.c2[k]);
+    __m256 il = _mm256_loadu_ps(&n.invLambda[k]), v0 = _mm256_loadu_ps(&n.Vzero[k]);
+    gx = _mm256_add_ps(gx, _mm256_sub_ps(potential8(pxp,pyv,x,y,xd,yd,c2,il,v0),
+                                         potential8(pxm,pyv,x,y,xd,yd,c2,il,v0)));
+    gy = _mm256_add_ps(gy, _mm256_sub_ps(potential8(pxv,pyp,x,y,xd,yd,c2,il,v0),
+                                         potential8(pxv,pym,x,y,xd,yd,c2,il,v0)));
+  }
+  float sx = sum8(gx) / (2*H), sy = sum8(gy) / (2*H);
+  gradPotScalar(n, k, count, px, py, sx, sy);
+  return std::pair<float,float>(sx, sy);
+}
+
+const char* SocialForce::getInstructionSet() {
+  return "AVX2";
+}
+
+#elif defined(__SSE2__)
+
+static inline __m128 exp4(__m128 x) {
+  x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(EXP_LO)), _mm_set1_ps(EXP_HI));
+  __m128 fx = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(LOG2E)), _mm_set1_ps(0.5f));
+  //floor : la troncature arrondit vers 0, on corrige les négatifs
+  __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(fx));
+  fx = _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, fx), _mm_set1_ps(1.0f)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_HI)));
+  x = _mm_sub_ps(x, _mm_mul_ps(fx, _mm_set1_ps(LN2_LO)));
+  __m128 x2 = _mm_mul_ps(x, x);
+  __m128 y = _mm_set1_ps(P0);
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(P1));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(P2));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(P3));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(P4));
+  y = _mm_add_ps(_mm_mul_ps(y, x), _mm_set1_ps(P5));
+  y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, x2), x), _mm_set1_ps(1.0f));
+  __m128i n = _mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(127));
+  return _mm_mul_ps(y, _mm_castsi128_ps(_mm_slli_epi32(n, 23)));
+}
+
+static inline __m128 potential4(__m128 px,__m128 py,__m128 x,__m128 y,__m128 xd,__m128 yd,
+                                __m128 c2,__m128 invLambda,__m128 Vzero) {
+  __m128 dx1 = _mm_sub_ps(px, x), dy1 = _mm_sub_ps(py, y);
+  __m128 dx2 = _mm_sub_ps(px, xd), dy2 = _mm_sub_ps(py, yd);
+  __m128 d1 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx1, dx1), _mm_mul_ps(dy1, dy1)));
+  __m128 d2 = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx2, dx2), _mm_mul_ps(dy2, dy2)));
+  __m128 a = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_add_ps(d1, d2));
+  __m128 b2 = _mm_max_ps(_mm_sub_ps(_mm_mul_ps(a, a), c2), _mm_setzero_ps());
+  __m128 b = _mm_sqrt_ps(b2);
+  return _mm_mul_ps(Vzero, exp4(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(b, invLambda))));
+}
+
+static inline float sum4(__m128 s) {
+  s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+  s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+  return _mm_cvtss_f32(s);
+}
+
+std::pair<float,float> SocialForce::gradPot(float px,float py,const NeighbourBatch& n) {
+  const int count = n.size();
+  const __m128 pxp = _mm_set1_ps(px+H), pxm = _mm_set1_ps(px-H), pxv = _mm_set1_ps(px);
+  const __m128 pyp = _mm_set1_ps(py+H), pym = _mm_set1_ps(py-H), pyv = _mm_set1_ps(py);
+  __m128 gx = _mm_setzero_ps(), gy = _mm_setzero_ps();
+  int k = 0;
+  for (; k + 4 <= count; k += 4) {
+    __m128 x = _mm_loadu_ps(&n.x[k]), y = _mm_loadu_ps(&n.y[k]);
+    __m128 xd = _mm_loadu_ps(&n.xDeltaT[k]), yd = _mm_loadu_ps(&n.yDeltaT[k]);
+    __m128 c2 = _mm_loadu_ps(&n.c2[k]);
+    __m128 il = _mm_loadu_ps(&n.invLambda[k]), v0 = _mm_loadu_ps(&n.Vzero[k]);
+    gx = _mm_add_ps(gx, _mm_sub_ps(potential4(pxp,pyv,x,y,xd,yd,c2,il,v0),
+                                   potential4(pxm,pyv,x,y,xd,yd,c2,il,v0)));
+    gy = _mm_add_ps(gy, _mm_sub_ps(potential4(pxv,pyp,x,y,xd,yd,c2,il,v0),
+                                   potential4(pxv,pym,x,y,xd,yd,c2,il,v0)));
+  }
+  float sx = sum4(gx) / (2*H), sy = sum4(gy) / (2*H);
+  gradPotScalar(n, k, count, px, py, sx, sy);
+  return std::pair<float,float>(sx, sy);
+}
+
+const char* SocialForce::getInstructionSet() {
+  return "SSE2";
+}
+
+#else
+
+std::pair<float,float> SocialForce::gradPot(float px,float py,const NeighbourBatch& n) {
+  float sx = 0, sy = 0;
+  gradPotScalar(n, 0, n.size(), px, py, sx, sy);
+  return std::pair<float,float>(sx, sy);
+}
+
+const char* SocialForce::getInstructionSet() {
+  return "scalar";
+}
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef SOCIAL_FORCE_H
+#define SOCIAL_FORCE_H
+
+#include <vector>
+#include <utility>
+
+/**
+ * @brief The NeighbourBatch class
+ * the Characters around a NPC, packed by arrays for SocialForce::gradPot.
+ * Only what the potential needs is kept : the position, the position at
+ * t+deltaT, the squared half focal distance of the ellipse and the
+ * parameters of Character::potential.
+ */
+class NeighbourBatch {
+ public:
+  /**
+   * @brief clear
+   * empties the batch, keeping its memory
+   */
+  void clear();
+
+  /**
+   * @brief push
+   * adds a Character in (x,y) with speed (vx,vy) and parameters deltaT,
+   * lambda and Vzero, see Character::potential
+   */
+  void push(float x,float y,float vx,float vy,float deltaT,float lambda,float Vzero);
+
+  int size() const {
+    return (int) x.size();
+  }
+
+  std::vector<float> x, y;
+  std::vector<float> xDeltaT, yDeltaT; // position at t+deltaT
+  std::vector<float> c2;               // (0.5*|v|*deltaT)^2
+  std::vector<float> invLambda;
+  std::vector<float> Vzero;
+};
+
+/**
+ * @brief The SocialForce class
+ * computes the repulsion of a whole NeighbourBatch at once, with AVX2 or SSE2
+ * when the compiler targets them and a scalar loop otherwise.
+ * It gives the same result as summing Character::gradPot over the batch,
+ * up to the precision of the vectorised exp.
+ */
+class SocialForce {
+ public:
+  /**
+   * @brief gradPot
+   * computes at (px,py) the sum of the gradients of the potentials created
+   * by the Characters of the batch
+   */
+  static std::pair<float,float> gradPot(float px,float py,const NeighbourBatch& batch);
+
+  /**
+   * @brief getInstructionSet
+   * @return the name of the instructions used by gradPot ("AVX2", "SSE2" or "scalar")
+   */
+  static const char* getInstructionSet();
+};
+
+#endif // SOCIAL_FORCE_H
@@ -0,0 +1,69 @@
+#include "spatialIndex.h"
+#include <cassert>
+
+
+SpatialIndex::SpatialIndex() : width(0), height(0), count(0) {
+}
+
+
+SpatialIndex::SpatialIndex(int width, int height) : width(0), height(0), count(0) {
+  reset(width,height);
+}
+
+
+void SpatialIndex::reset(int width, int height) {
+  this->width = width;
+  this->height = height;
+  count = 0;
+  cells.assign(width*height, Cell());
+  return;
+}
+
+
+void SpatialIndex::insert(NpcHandle npc, int i, int j) {
+  assert(i >= 0 && i < width && j >= 0 && j < height);
+  cells[i*height + j].push_back(npc);
+  count++;
+  return;
+}
+
+
+bool SpatialIndex::remove(NpcHandle npc, int i, int j) {
+  assert(i >= 0 && i < width && j >= 0 && j < height);
+  Cell& cell = cells[i*height + j];
+  for (unsigned int k = 0; k < cell.size(); k++) {
+    if (cell[k] == npc) {
+      // l'ordre dans une case n'a pas d'importance
+      cell[k] = cell.back();
+      cell.pop_back();
+      count--;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void SpatialIndex::move(NpcHandle npc, int i0, int j0, int i1, int j1) {
+  if (i0 == i1 && j0 == j1) {
+    return;
+  }
+  if (remove(npc,i0,j0)) {
+    insert(npc,i1,j1);
+  }
+  return;
+}
+
+
+void SpatialIndex::clear() {
+  for (Cell& cell : cells) {
+    cell.clear();
+  }
+  count = 0;
+  return;
+}
+
+
+int SpatialIndex::size() const {
+  return count;
+}
@@ -0,0 +1,142 @@
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include "npcStore.h"
+
+/**
+ * @brief The SpatialIndex class
+ * is a uniform grid with one cell per tile, each cell holding the handles
+ * of the NPCs standing in that tile.
+ * The cells are stored contiguously (cell (i,j) is at i*height+j) and keep
+ * their capacity, so once warmed up neither updates nor queries allocate.
+ * A radius query only looks at the (2r+1)² cells around a tile, whatever
+ * the total number of NPCs.
+ */
+class SpatialIndex {
+ public:
+  /**
+   * @brief Cell
+   * the handles of the NPCs of a tile, as a span
+   */
+  typedef std::vector<NpcHandle> Cell;
+
+  /**
+   * @brief SpatialIndex
+   * creates an empty index of size 0x0, use reset before inserting anything
+   */
+  SpatialIndex();
+
+  /**
+   * @brief SpatialIndex
+   * creates an empty index covering a map of width x height tiles
+   */
+  SpatialIndex(int width, int height);
+
+  /**
+   * @brief reset
+   * empties the index and resizes it
+   * @param width : the map width in tiles
+   * @param height : the map height in tiles
+   */
+  void reset(int width, int height);
+
+  /**
+   * @brief insert
+   * adds a NPC to the cell (i,j)
+   */
+  void insert(NpcHandle npc, int i, int j);
+
+  /**
+   * @brief remove
+   * removes a NPC from the cell (i,j)
+   * @return false if the NPC was not in this cell
+   */
+  bool remove(NpcHandle npc, int i, int j);
+
+  /**
+   * @brief move
+   * moves a NPC from the cell (i0,j0) to the cell (i1,j1)
+   */
+  void move(NpcHandle npc, int i0, int j0, int i1, int j1);
+
+  /**
+   * @brief clear
+   * removes every NPC but keeps the cells' memory
+   */
+  void clear();
+
+  /**
+   * @brief size
+   * @return the number of NPCs in the index
+   */
+  int size() const;
+
+  int getWidth() const { return width; }
+  int getHeight() const { return height; }
+
+  /**
+   * @brief getCell
+   * @return the handles of the NPCs in the tile (i,j), which must be in the map
+   */
+  const Cell& getCell(int i, int j) const {
+    return cells[i*height + j];
+  }
+
+  /**
+   * @brief forEachInRadius
+   * calls visit(NpcHandle) for every NPC in the square of tiles
+   * [i-r,i+r]x[j-r,j+r] clipped to the map
+   */
+  template <typename Visitor>
+  void forEachInRadius(int i, int j, int r, Visitor&& visit) const;
+
+  /**
+   * @brief forEachInDiamond
+   * calls visit(NpcHandle) for every NPC in a tile at manhattan distance at most
+   * r of (i,j), like Geography::neighbors
+   */
+  template <typename Visitor>
+  void forEachInDiamond(int i, int j, int r, Visitor&& visit) const;
+
+ private:
+  int width;
+  int height;
+  int count;
+  std::vector<Cell> cells;
+};
+
+
+template <typename Visitor>
+void SpatialIndex::forEachInRadius(int i, int j, int r, Visitor&& visit) const {
+  int i0 = std::max(i-r,0), i1 = std::min(i+r+1,width);
+  int j0 = std::max(j-r,0), j1 = std::min(j+r+1,height);
+  for (int a = i0; a < i1; a++) {
+    const Cell* cell = &cells[a*height + j0];
+    for (int b = j0; b < j1; b++, cell++) {
+      for (NpcHandle npc : *cell) {
+        visit(npc);
+      }
+    }
+  }
+}
+
+
+template <typename Visitor>
+void SpatialIndex::forEachInDiamond(int i, int j, int r, Visitor&& visit) const {
+  int i0 = std::max(i-r,0), i1 = std::min(i+r+1,width);
+  for (int a = i0; a < i1; a++) {
+    int w = r - std::abs(a-i);
+    int j0 = std::max(j-w,0), j1 = std::min(j+w+1,height);
+    const Cell* cell = &cells[a*height + j0];
+    for (int b = j0; b < j1; b++, cell++) {
+      for (NpcHandle npc : *cell) {
+        visit(npc);
+      }
+    }
+  }
+}
+
+#endif // SPATIAL_INDEX_H
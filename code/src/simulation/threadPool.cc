@@ -0,0 +1,120 @@
+#include "threadPool.h"
+#include <algorithm>
+
+
+ThreadPool::ThreadPool(int n) : body(nullptr), remaining(0), job(0), stopping(false) {
+  if (n <= 0) {
+    n = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (int i = 0; i < n; i++) {
+    queues.emplace_back(new Queue());
+  }
+  for (int i = 1; i < n; i++) {
+    threads.emplace_back(&ThreadPool::workerLoop, this, i);
+  }
+}
+
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread& t : threads) {
+    t.join();
+  }
+}
+
+
+int ThreadPool::getThreadCount() const {
+  return queues.size();
+}
+
+
+void ThreadPool::parallelFor(int first, int last, int grain, const std::function<void(int,int)>& f) {
+  if (last <= first) {
+    return;
+  }
+  grain = std::max(grain, 1);
+  if (threads.empty() || last - first <= grain) {
+    f(first, last);
+    return;
+  }
+
+  std::lock_guard<std::mutex> call(callLock);
+  int chunks = (last - first + grain - 1) / grain;
+  {
+    std::lock_guard<std::mutex> guard(jobLock);
+    body = &f;
+    remaining = chunks;
+    // des blocs contigus par thread, pour qu'ils lisent des zones mémoire voisines
+    int n = queues.size();
+    for (int k = 0; k < chunks; k++) {
+      Queue& q = *queues[(long) k * n / chunks];
+      std::lock_guard<std::mutex> qGuard(q.lock);
+      Range r = {first + k*grain, std::min(last, first + (k+1)*grain)};
+      q.ranges.push_back(r);
+    }
+    job++;
+  }
+  wake.notify_all();
+
+  work(0);
+
+  std::unique_lock<std::mutex> guard(jobLock);
+  done.wait(guard, [this] { return remaining == 0; });
+  body = nullptr;
+  return;
+}
+
+
+bool ThreadPool::take(int self, Range& r) {
+  int n = queues.size();
+  for (int k = 0; k < n; k++) {
+    Queue& q = *queues[(self + k) % n];
+    std::lock_guard<std::mutex> guard(q.lock);
+    if (!q.ranges.empty()) {
+      if (k == 0) {
+        // sa propre file : par devant
+        r = q.ranges.front();
+        q.ranges.pop_front();
+      } else {
+        // la file d'un autre : par derrière
+        r = q.ranges.back();
+        q.ranges.pop_back();
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+
+void ThreadPool::work(int self) {
+  Range r;
+  while (take(self, r)) {
+    (*body)(r.begin, r.end);
+    if (--remaining == 0) {
+      std::lock_guard<std::mutex> guard(jobLock);
+      done.notify_all();
+    }
+  }
+  return;
+}
+
+
+void ThreadPool::workerLoop(int self) {
+  unsigned long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(jobLock);
+      wake.wait(guard, [&] { return stopping || job != seen; });
+      if (stopping) {
+        return;
+      }
+      seen = job;
+    }
+    work(self);
+  }
+}
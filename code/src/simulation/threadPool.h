@@ -0,0 +1,78 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+/**
+ * @brief The ThreadPool class
+ * runs loops in parallel on a fixed set of threads.
+ * A loop is cut in chunks which are spread over one queue per thread. Each
+ * thread empties its own queue first, then steals chunks at the back of the
+ * other queues, so uneven chunks don't leave threads idle.
+ * The calling thread works too : a pool of n threads starts n-1 threads.
+ * Only one loop runs at a time, and a body must not call parallelFor.
+ */
+class ThreadPool {
+ public:
+  /**
+   * @brief ThreadPool
+   * @param threads : the number of threads, including the calling thread
+   * (0 to use one per core)
+   */
+  explicit ThreadPool(int threads = 0);
+  ThreadPool(ThreadPool&) = delete;
+  ~ThreadPool();
+
+  /**
+   * @brief getThreadCount
+   * @return the number of threads, including the calling thread
+   */
+  int getThreadCount() const;
+
+  /**
+   * @brief parallelFor
+   * calls body(begin,end) on chunks of at most grain indices covering
+   * [first,last[, and returns once every chunk is done
+   * @param first : the first index
+   * @param last : the index after the last one
+   * @param grain : the size of the chunks
+   * @param body : the function to call on each chunk
+   */
+  void parallelFor(int first, int last, int grain, const std::function<void(int,int)>& body);
+
+ private:
+  struct Range {
+    int begin;
+    int end;
+  };
+
+  struct Queue {
+    std::mutex lock;
+    std::deque<Range> ranges;
+  };
+
+  std::vector<std::thread> threads;
+  std::vector<std::unique_ptr<Queue> > queues; // queues[0] is the calling thread's
+
+  std::mutex callLock;       // one loop at a time
+  std::mutex jobLock;
+  std::condition_variable wake;
+  std::condition_variable done;
+  const std::function<void(int,int)>* body;
+  std::atomic<int> remaining;
+  unsigned long job;
+  bool stopping;
+
+  bool take(int self, Range& r);
+  void work(int self);
+  void workerLoop(int self);
+};
+
+#endif // THREAD_POOL_H
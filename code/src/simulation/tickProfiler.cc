@@ -0,0 +1,112 @@
+#include "tickProfiler.h"
+#include "tickScheduler.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+
+
+TickProfiler::TickProfiler() : dumpPeriod(sf::seconds(10)) {
+  reset();
+  return;
+}
+
+
+void TickProfiler::record(Phase phase, long long micros) {
+  PhaseStats& stats = phases[phase];
+  stats.samples++;
+  stats.total += micros;
+  stats.max = std::max(stats.max, micros);
+  int bucket = 0;
+  while (micros > 0 && bucket < BUCKETS - 1) {
+    micros >>= 1;
+    bucket++;
+  }
+  stats.buckets[bucket]++;
+  return;
+}
+
+
+long long TickProfiler::getPercentile(Phase phase, float p) const {
+  const PhaseStats& stats = phases[phase];
+  long long rank = (long long) (p * stats.samples);
+  long long seen = 0;
+  for (int b = 0; b < BUCKETS; b++) {
+    seen += stats.buckets[b];
+    if (seen > rank) {
+      return b == 0 ? 1 : 1LL << b;
+    }
+  }
+  return stats.max;
+}
+
+
+const char* TickProfiler::getPhaseName(Phase phase) {
+  static const char* names[PHASE_COUNT] = {
+    "tick", "network", "actions", "diffusion", "movement", "broadcast", "updates"
+  };
+  return names[phase];
+}
+
+
+const char* TickProfiler::getCounterName(Counter counter) {
+  static const char* names[COUNTER_COUNT] = {
+    "npcs_moved", "tile_changes", "pathfinding_calls", "routes_checked", "messages_sent"
+  };
+  return names[counter];
+}
+
+
+void TickProfiler::reset() {
+  memset(phases, 0, sizeof(phases));
+  memset(counters, 0, sizeof(counters));
+  return;
+}
+
+
+void TickProfiler::write(std::ostream& out, unsigned long tick) const {
+  out << "{\"tick\": " << tick << ", \"phases\": {";
+  for (int p = 0; p < PHASE_COUNT; p++) {
+    const PhaseStats& stats = phases[p];
+    Phase phase = (Phase) p;
+    out << (p > 0 ? ", " : "") << "\"" << getPhaseName(phase) << "\": {"
+        << "\"samples\": " << stats.samples
+        << ", \"total_us\": " << stats.total
+        << ", \"max_us\": " << stats.max
+        << ", \"p50_us\": " << getPercentile(phase, 0.5)
+        << ", \"p99_us\": " << getPercentile(phase, 0.99)
+        << ", \"histogram\": [";
+    //on coupe les seaux vides de la fin
+    int last = BUCKETS;
+    while (last > 1 && stats.buckets[last-1] == 0) {
+      last--;
+    }
+    for (int b = 0; b < last; b++) {
+      out << (b > 0 ? ", " : "") << stats.buckets[b];
+    }
+    out << "]}";
+  }
+  out << "}, \"counters\": {";
+  for (int c = 0; c < COUNTER_COUNT; c++) {
+    out << (c > 0 ? ", " : "") << "\"" << getCounterName((Counter) c) << "\": " << counters[c];
+  }
+  out << "}}" << std::endl;
+  return;
+}
+
+
+void TickProfiler::setDumpFile(const std::string& path, sf::Time period) {
+  dumpPath = path;
+  dumpPeriod = period;
+  return;
+}
+
+
+void TickProfiler::endTick(const TickScheduler& scheduler) {
+  if (dumpPath.empty() || !scheduler.every(dumpPeriod)) {
+    return;
+  }
+  std::ofstream file(dumpPath.c_str(), std::ofstream::app);
+  write(file, scheduler.getTick());
+  reset();
+  return;
+}
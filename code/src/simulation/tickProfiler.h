@@ -0,0 +1,155 @@
+#ifndef TICK_PROFILER_H
+#define TICK_PROFILER_H
+
+#include <chrono>
+#include <string>
+#include <ostream>
+#include <SFML/System.hpp>
+
+class TickScheduler;
+
+/**
+ * @brief The TickProfiler class
+ * always-on timing of the phases of a simulation tick, and counters of what
+ * the tick did.
+ *
+ * Each phase keeps its number of samples, total and max duration, and a
+ * histogram of its durations with power-of-two buckets : bucket 0 is below
+ * 1 microsecond, bucket b in [2^(b-1), 2^b[ microseconds. Timing a phase
+ * costs two reads of a steady clock. Each phase is measured by one timer ;
+ * a sub-phase (BROADCAST) is also counted in the phase it runs in (UPDATES),
+ * as every phase is in TICK.
+ * The statistics cover the window since the last reset(), or since endTick()
+ * last wrote them to the dump file with write(). The profiler is used by the
+ * simulation thread only.
+ */
+class TickProfiler {
+ public:
+  enum Phase {
+    TICK,        // the whole run()
+    NETWORK,     // receiving the messages
+    ACTIONS,     // running the pending ScenarioActions
+    DIFFUSION,   // lisserMatrice
+    MOVEMENT,    // moving the players and the NPCs
+    BROADCAST,   // sending the snapshots of the NPCs, a sub-phase of UPDATES
+    UPDATES,     // server->update / client->update, BROADCAST included
+    PHASE_COUNT
+  };
+
+  enum Counter {
+    NPCS_MOVED,
+    TILE_CHANGES,
+    PATHFINDING_CALLS,
+    ROUTES_CHECKED,     // paths checked because tiles were blocked
+    MESSAGES_SENT,
+    COUNTER_COUNT
+  };
+
+  static const int BUCKETS = 24;
+
+  /**
+   * @brief The ScopedTimer class
+   * adds the time between its construction and its destruction to a phase
+   */
+  class ScopedTimer {
+   public:
+    ScopedTimer(TickProfiler& profiler, Phase phase) :
+      profiler(profiler), phase(phase), start(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer&) = delete;
+    ~ScopedTimer() {
+      profiler.record(phase, std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - start).count());
+    }
+   private:
+    TickProfiler& profiler;
+    Phase phase;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  TickProfiler();
+
+  /**
+   * @brief record
+   * adds a sample of a phase
+   * @param micros : its duration, in microseconds
+   */
+  void record(Phase phase, long long micros);
+
+  void count(Counter counter, long long n = 1) {
+    counters[counter] += n;
+  }
+
+  long long getCounter(Counter counter) const {
+    return counters[counter];
+  }
+
+  long long getSamples(Phase phase) const {
+    return phases[phase].samples;
+  }
+
+  long long getTotal(Phase phase) const {
+    return phases[phase].total;
+  }
+
+  long long getMax(Phase phase) const {
+    return phases[phase].max;
+  }
+
+  long long getBucket(Phase phase, int bucket) const {
+    return phases[phase].buckets[bucket];
+  }
+
+  /**
+   * @brief getPercentile
+   * @param p : between 0 and 1
+   * @return an upper bound, in microseconds, of the p-quantile of the
+   * durations of the phase (the end of its histogram bucket)
+   */
+  long long getPercentile(Phase phase, float p) const;
+
+  static const char* getPhaseName(Phase phase);
+  static const char* getCounterName(Counter counter);
+
+  /**
+   * @brief reset
+   * starts a new window of statistics
+   */
+  void reset();
+
+  /**
+   * @brief write
+   * writes the statistics of the window as one line of JSON
+   * @param tick : the tick the statistics end at
+   */
+  void write(std::ostream& out, unsigned long tick) const;
+
+  /**
+   * @brief setDumpFile
+   * makes endTick append the statistics to a file periodically
+   * @param path : the file, nothing is dumped if empty
+   * @param period : the time, in ticks of the simulation, between two dumps
+   */
+  void setDumpFile(const std::string& path, sf::Time period = sf::seconds(10));
+
+  /**
+   * @brief endTick
+   * to be called at the end of each tick : dumps the window to the dump
+   * file and resets it when the period is over
+   */
+  void endTick(const TickScheduler& scheduler);
+
+ private:
+  struct PhaseStats {
+    long long samples;
+    long long total;
+    long long max;
+    long long buckets[BUCKETS];
+  };
+
+  PhaseStats phases[PHASE_COUNT];
+  long long counters[COUNTER_COUNT];
+  std::string dumpPath;
+  sf::Time dumpPeriod;
+};
+
+#endif // TICK_PROFILER_H
@@ -0,0 +1,47 @@
+#include "tickScheduler.h"
+#include <algorithm>
+#include <cmath>
+
+
+TickScheduler::TickScheduler(int ticksPerSecond, int maxCatchUp) :
+  maxCatchUp(maxCatchUp), accumulator(sf::Time::Zero), tick(0) {
+  setTickRate(ticksPerSecond);
+  return;
+}
+
+
+void TickScheduler::setTickRate(int ticksPerSecond) {
+  this->ticksPerSecond = std::max(1, ticksPerSecond);
+  tickLength = sf::microseconds(1000000 / this->ticksPerSecond);
+  return;
+}
+
+
+int TickScheduler::advance(sf::Time elapsed) {
+  accumulator += elapsed;
+  int ticks = (int) (accumulator.asMicroseconds() / tickLength.asMicroseconds());
+  if (ticks > maxCatchUp) {
+    //trop en retard : on abandonne le temps qu'on ne rattrapera pas
+    ticks = maxCatchUp;
+    accumulator = sf::Time::Zero;
+  } else {
+    accumulator -= sf::microseconds(tickLength.asMicroseconds() * ticks);
+  }
+  return ticks;
+}
+
+
+int TickScheduler::waitNextTick() {
+  int ticks = advance(clock.restart());
+  while (ticks == 0) {
+    sf::sleep(tickLength - accumulator);
+    ticks = advance(clock.restart());
+  }
+  return ticks;
+}
+
+
+bool TickScheduler::every(sf::Time period) const {
+  long ticksPerPeriod = std::max(1L, std::lround((double) period.asMicroseconds() / tickLength.asMicroseconds()));
+  return tick % (unsigned long) ticksPerPeriod == 0;
+}
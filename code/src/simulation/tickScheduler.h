@@ -0,0 +1,93 @@
+#ifndef TICK_SCHEDULER_H
+#define TICK_SCHEDULER_H
+
+#include <SFML/System.hpp>
+
+/**
+ * @brief The TickScheduler class
+ * cuts the real time in ticks of fixed length, so that the simulation
+ * always advances by the same dt whatever the speed of the loop driving it.
+ *
+ * The real time elapsed is accumulated and turned into whole ticks ; what
+ * remains waits for the next call. If the loop is late by more than
+ * maxCatchUp ticks, the extra time is dropped rather than run in a burst.
+ * The scheduler also counts the ticks actually run (see startTick), which
+ * the periodic tasks of the simulation key off through every().
+ */
+class TickScheduler {
+ public:
+  /**
+   * @brief TickScheduler
+   * @param ticksPerSecond : the tick rate
+   * @param maxCatchUp : the most ticks returned at once by advance
+   */
+  explicit TickScheduler(int ticksPerSecond = 30, int maxCatchUp = 5);
+
+  /**
+   * @brief setTickRate
+   * changes the tick rate, the time already accumulated is kept
+   */
+  void setTickRate(int ticksPerSecond);
+
+  int getTickRate() const {
+    return ticksPerSecond;
+  }
+
+  /**
+   * @brief getTickLength
+   * @return the dt of every tick
+   */
+  sf::Time getTickLength() const {
+    return tickLength;
+  }
+
+  /**
+   * @brief advance
+   * adds real time to the accumulator
+   * @param elapsed : the real time since the last call
+   * @return the number of ticks to run now
+   */
+  int advance(sf::Time elapsed);
+
+  /**
+   * @brief waitNextTick
+   * sleeps until at least one tick is due, measuring the real time itself
+   * (for loops which have nothing else to do, like the server's)
+   * @return the number of ticks to run now
+   */
+  int waitNextTick();
+
+  /**
+   * @brief startTick
+   * counts a new tick, to be called when the simulation runs one
+   */
+  void startTick() {
+    tick++;
+  }
+
+  /**
+   * @brief getTick
+   * @return the number of ticks run since the start
+   */
+  unsigned long getTick() const {
+    return tick;
+  }
+
+  /**
+   * @brief every
+   * @param period : the period of a task
+   * @return true if the task is due at the current tick, ie once every
+   * period (rounded to a whole number of ticks)
+   */
+  bool every(sf::Time period) const;
+
+ private:
+  int ticksPerSecond;
+  int maxCatchUp;
+  sf::Time tickLength;
+  sf::Time accumulator;
+  sf::Clock clock;
+  unsigned long tick;
+};
+
+#endif // TICK_SCHEDULER_H
@@ -3,11 +3,12 @@
  */
 #include "trajectory.h"
 #include "../generation/tile.h"
-#include "tilewrapper.h"
+#include "roadGraph.h"
+#include "../generation/navGrid.h"
 #include "npc.h"
+#include "flowField.h"
 
 #include <vector>
-#include <list>
 #include <cassert>
 #include <queue>
 #include <random>
@@ -15,12 +16,11 @@
 #define DEBUG false
 
 Trajectory::Trajectory() {
-  Position p1,p2;
-  p1 = Position();
-  p2 = Position();
-  posList = std::list<Position> ();
-  posList.push_front(p2);
-  posList.push_front(p1);
+  position = Position();
+  target = Position();
+  next = 0;
+  height = 1;
+  offset = std::pair<float,float>(0.5,0.5);
   hasArrived = false;
   speed = std::pair<float,float>(0,0);
   acceleration = std::pair<float,float>(0,0);
@@ -31,8 +31,11 @@ Trajectory::Trajectory() {
 
 
 Trajectory::Trajectory(Position start) {
-  posList = std::list<Position> ();
-  posList.push_front(start);
+  position = start;
+  target = start;
+  next = 0;
+  height = 1;
+  offset = std::pair<float,float>(0.5,0.5);
   hasArrived = true;
   speed = std::pair<float,float>(0,0);
   acceleration = std::pair<float,float>(0,0);
@@ -42,192 +45,238 @@ Trajectory::Trajectory(Position start) {
 }
 
 
-void Trajectory::setTarget(Position target, Geography& map) {
-  Position curPos = posList.front();
-  posList.clear();
-  posList.push_front(target);
-  posList.push_front(curPos);
+void Trajectory::setTarget(Position t, Geography& map) {
+  target = t;
+  route.reset();
+  field.reset();
   pathfinding(map);
   hasArrived = false;
   return;
 }
 
 
-void Trajectory::explore(TileWrapper* y,TileWrapper* z,PriorityQueue& open) {
-  if (!y->isClosed()) {
-    if (y->isOpen()) {
-      if (z->getDistance()+1<y->getDistance()) {
-        y->setParent(z);
-        y->setDistance(z->getDistance()+1);
-        open.increase(y->getHandle());
-      }
-    } else {
-      y->setOpen(true);
-      y->setParent(z);
-      y->setDistance(z->getDistance()+1);
-      PriorityQueue::handle_type h = open.push(y);
-      y->setHandle(h);
-    }
+void Trajectory::headTowards(Position t) {
+  //on garde l'ancien chemin s'il y en a un, sinon on va tout droit
+  if (hasArrived || !route || field) {
+    target = t;
+    route.reset();
   }
+  field.reset();
+  hasArrived = false;
   return;
 }
 
 
-void Trajectory::pathfinding(Geography& map) {
-  assert(posList.size()>1);//le vecteur doit contenir au moins le départ et l'arrivée
-
-  std::default_random_engine offsetGen (rand());
-  std::uniform_real_distribution<float> offsetDist (0.01,0.99);
-
-  std::pair<float,float> offset (offsetDist(offsetGen),offsetDist(offsetGen));
-  Position start,target;
-  //on ne garde que le départ et l'arrivée et on élimine tout le reste
-  start = posList.front();
-  target = posList.back();
-  posList.clear();
-  
-  PriorityQueue open;
-  std::list<TileWrapper*> closed;
-
-  Tile& tileStart = start.isInTile(map);
-  Tile& tileTarget = target.isInTile(map);
-
-  TileWrapper* s = new TileWrapper(&tileStart,tileTarget);
-  s->setDistance(0);
-  s->setOpen(true);
-  PriorityQueue::handle_type h = open.push(s);
-  s->setHandle(h);
-
-  TileWrapper* t = new TileWrapper(&tileTarget,tileTarget);
-
-  TileWrapper* temp = NULL;
-  bool found = false;
-  
-  //boucle principale de A*
-  while (!open.empty() && !found) {
-    //on récupère le premier élément ouvert
-    TileWrapper* z = open.top();
-    open.pop();
-    if (z->equals(*t)) {
-      temp = z;
-      found = true;
-    } else {
-      z->setClosed(true);
-      closed.push_front(z);
-
-      std::list<Tile*> neighbourTiles = z->getTile().getNeighbourTiles(map);
-      
-      //on explore tous ses voisins
-      while (!neighbourTiles.empty()) {
-        Tile* tempTile = neighbourTiles.front();
-        neighbourTiles.pop_front();
-        TileWrapper* y = tempTile->getWrapper();
-        if (y) {
-          explore(y,z,open);
-        } else {
-          y = new TileWrapper(tempTile,tileTarget);
-          explore(y,z,open);
-        }
-      }
+RouteCache::Route Trajectory::findPath(Geography& map, int start, int goal) {
+  RouteCache& cache = map.getRouteCache();
+  RouteCache::Route route = cache.find(start,goal);
+  if (route) {
+    return route;
+  }
+  unsigned int generation = cache.getGeneration();
+  //chaque thread a sa propre mémoire de recherche, réutilisée d'un appel à l'autre
+  static thread_local std::vector<int> tiles;
+  static thread_local std::vector<int> turns;
+  const NavGrid& grid = map.getNavGrid();
+  if (!map.getRoadGraph().findRoute(grid,start,goal,tiles,map.getLandmarks())) {
+    return route;
+  }
+  //on ne garde que les tiles où l'on tourne...
+  turns.clear();
+  turns.push_back(tiles.front());
+  for (size_t k = 1; k+1 < tiles.size(); k++) {
+    if (!grid.isAligned(turns.back(),tiles[k],tiles[k+1])) {
+      turns.push_back(tiles[k]);
+    }
+  }
+  if (tiles.size() > 1) {
+    turns.push_back(tiles.back());
+  }
+  //...puis on tire la ficelle : on saute chaque tournant d'où l'on voit le suivant
+  std::vector<int>* pulled = new std::vector<int>();
+  pulled->push_back(turns.front());
+  for (size_t k = 1; k+1 < turns.size(); k++) {
+    if (!grid.inSight(pulled->back(),turns[k+1])) {
+      pulled->push_back(turns[k]);
     }
   }
+  if (turns.size() > 1) {
+    pulled->push_back(turns.back());
+  }
+  route.reset(pulled);
+  cache.insert(start,goal,route,generation);
+  return route;
+}
+
+
+RouteCache::Route Trajectory::findPath(Geography& map, Position start, Position target) {
+  const NavGrid& grid = map.getNavGrid();
+  std::pair<int,int> startTile = start.isInTile();
+  std::pair<int,int> targetTile = target.isInTile();
+  assert(map.isInTheMap(startTile.first,startTile.second) && map.isInTheMap(targetTile.first,targetTile.second));
+  return findPath(map,grid.getId(startTile.first,startTile.second),grid.getId(targetTile.first,targetTile.second));
+}
+
+
+void Trajectory::pathfinding(Geography& map) {
+  RouteCache::Route found = findPath(map,position,target);
   if (!found) {
-    printf("départ : %f %f, arrivée : %f %f\n",start.getX(),start.getY(),target.getX(),target.getY());
+    printf("départ : %f %f, arrivée : %f %f\n",position.getX(),position.getY(),target.getX(),target.getY());
   }
   //found signifie qu'on a pu atteindre l'objectif
   //s'il est faux c'est que c'est impossible
   assert(found);
   //si la map n'est pas connexe voir avec Chatan
-  //sinon on a temp = tilewrapper de target
-
-  //A* est fini, maintenant il faut reconstruire le chemin
-  posList.push_front(target);
-  
-  //on retient les 2 tiles précédentes pour tester l'alignement
-  Tile previousPreviousTile = tileTarget;
-  Tile previousTile = tileTarget;
-
-  while (!temp->equals(*s)) {
-    temp = temp->getParent();
-    assert(temp);//temp=null signifie pas de parent
-    Position tempPos = Position(temp->getTile().getCoord().getAbs() + offset.first,
-                                temp->getTile().getCoord().getOrd() + offset.second);
-    
-    if (temp->getTile().isAligned(previousPreviousTile,previousTile)) {
-      //les 3 tiles sont alignées : on supprime celle du milieu qui ne sert à rien
-      //previousPreviousTile ne change pas
-      posList.pop_front();
-    } else {
-      previousPreviousTile = previousTile;
-    }
-    previousTile = temp->getTile();
-    posList.push_front(tempPos);
+  if (!found) {
+    return;
+  }
+  followPath(found,map.getNavGrid(),target);
+  return;
+}
 
-    if (DEBUG) {
-      printf("pathfinding: tile %d %d position %f %f\n",temp->getTile().getCoord().getAbs(),temp->getTile().getCoord().getOrd(),posList.front().getX(),posList.front().getY());
+
+void Trajectory::followPath(const RouteCache::Route& path, const NavGrid& grid, Position t) {
+  std::default_random_engine offsetGen (rand());
+  std::uniform_real_distribution<float> offsetDist (0.01,0.99);
+
+  offset = std::pair<float,float>(offsetDist(offsetGen),offsetDist(offsetGen));
+  //la première tile est celle du départ, où l'on est déjà
+  route = path;
+  next = 1;
+  height = grid.getHeight();
+  target = t;
+  field.reset();
+  hasArrived = false;
+  if (DEBUG) {
+    for (int tile : *route) {
+      printf("pathfinding: tile %d %d\n",grid.getAbs(tile),grid.getOrd(tile));
     }
   }
-  posList.pop_front();
-  posList.push_front(start);
+  return;
+}
 
-  //maintenant on nettoie soigneusement tous les tilewrapper générés
-  tileTarget.resetWrapper();
 
-  while(!open.empty()) {
-    TileWrapper* tempWrapper = open.top();
-    open.pop();
-    tempWrapper->getTile().resetWrapper();
+bool Trajectory::repairPath(Geography& map) {
+  //le champ est tenu à jour par la carte
+  if (field || hasArrived) {
+    return true;
+  }
+  const NavGrid& grid = map.getNavGrid();
+  //les tiles du reste du chemin, de celle où l'on est à celle de la cible
+  std::vector<int> tiles;
+  std::pair<int,int> t = position.isInTile();
+  tiles.push_back(grid.getId(t.first,t.second));
+  //une route d'une seule tile (la cible est dans la tile de départ) n'a pas d'étape
+  if (route && next < (int) route->size()-1) {
+    tiles.insert(tiles.end(), route->begin()+next, route->end()-1);
+  }
+  t = target.isInTile();
+  tiles.push_back(grid.getId(t.first,t.second));
+
+  //les étapes coupées, de first à last
+  int first = -1, last = -1;
+  for (int k = 0; k+1 < (int) tiles.size(); k++) {
+    if (!grid.isClear(tiles[k],tiles[k+1])) {
+      if (first == -1) {
+        first = k;
+      }
+      last = k;
+    }
+  }
+  if (first == -1) {
+    return true;
+  }
+  if (grid.isBlocked(tiles[first]) || grid.isBlocked(tiles[last+1])) {
+    return false;
+  }
+  RouteCache::Route detour = findPath(map,tiles[first],tiles[last+1]);
+  if (!detour) {
+    return false;
   }
 
-  while(!closed.empty()) {
-    TileWrapper* tempWrapper = closed.front();
-    closed.pop_front();
-    tempWrapper->getTile().resetWrapper();
+  std::vector<int>* spliced = new std::vector<int>(tiles.begin(), tiles.begin()+first+1);
+  spliced->insert(spliced->end(), detour->begin()+1, detour->end()-1);
+  spliced->insert(spliced->end(), tiles.begin()+last+1, tiles.end());
+  if (!route) {
+    offset = std::pair<float,float>(0.5,0.5);
   }
+  route.reset(spliced);
+  next = 1;
+  height = grid.getHeight();
+  return true;
+}
+
+
+void Trajectory::followField(std::shared_ptr<const FlowField> f, Position goal) {
+  target = goal;
+  route.reset();
+  field = f;
+  hasArrived = false;
   return;
 }
-      
-
-void Trajectory::updateTimer(Position& oldPos,Position& newPos,float speedNorm,sf::Time dt,Geography& map) {
-  if (ignoreTarget) {
-    timeoutIgnoreTarget -= dt;
-    if (timeoutIgnoreTarget <= sf::Time::Zero) {
-      ignoreTarget = false;
-      timeoutIgnoreTarget = sf::seconds(3./speedNorm);
+
+
+void Trajectory::updateTimer(bool sameTile,float speedNorm,float dt,float& timer,unsigned char& flags,unsigned int& seed) {
+  if (flags & NpcStore::IGNORE_TARGET) {
+    timer -= dt;
+    if (timer <= 0) {
+      flags &= ~NpcStore::IGNORE_TARGET;
+      timer = 3./speedNorm;
       //le timer avant de faire n'importe quoi est de n fois le temps normalement nécessaire pour parcourir la tile
       //avec n=3
     }
   } else {
-    if (oldPos.isInTile(map).equals(newPos.isInTile(map))) {
-      timeoutIgnoreTarget -= dt;
-      if (timeoutIgnoreTarget <= sf::Time::Zero) {
+    if (sameTile) {
+      timer -= dt;
+      if (timer <= 0) {
         //on est resté coincé trop longtemps : on fait n'importe quoi quelque temps
-        ignoreTarget = true;
-        std::default_random_engine gen (rand());
+        flags |= NpcStore::IGNORE_TARGET;
+        std::default_random_engine gen (seed);
         std::uniform_real_distribution<float> timeoutDist (0,0.5);
-        timeoutIgnoreTarget = sf::seconds(timeoutDist(gen));
+        timer = timeoutDist(gen);
+        seed = gen();
       }
     } else {
-      timeoutIgnoreTarget = sf::seconds(3./speedNorm);
+      timer = 3./speedNorm;
     }
   }
   return;
 }
 
    
-std::list<Position>& Trajectory::getPosList() {
-  return posList;
+Position Trajectory::getWaypoint() const {
+  if (route && next+1 < (int) route->size()) {
+    int tile = (*route)[next];
+    return Position(tile / height + offset.first, tile % height + offset.second);
+  }
+  return target;
+}
+
+
+void Trajectory::getWaypoints(std::vector<Position>& points) const {
+  points.clear();
+  points.push_back(position);
+  if (hasArrived) {
+    return;
+  }
+  if (route) {
+    for (int k = next; k+1 < (int) route->size(); k++) {
+      int tile = (*route)[k];
+      points.push_back(Position(tile / height + offset.first, tile % height + offset.second));
+    }
+  }
+  points.push_back(target);
+  return;
 }
 
 
 Position& Trajectory::getPosition() {
-  return posList.front();
+  return position;
 }
 
 
 void Trajectory::setPosition(Position& p) {
-  posList.pop_front();
-  posList.push_front(p);
+  position = p;
   return;
 }
 
@@ -237,99 +286,146 @@ bool Trajectory::getHasArrived() {
 }
 
 
-void Trajectory::update(sf::Time dt,float speedNorm,Geography& map,NPC& npc) {
-  assert(!posList.empty());//il doit y avoir au moins la position courante  
-  if (!hasArrived) {//si on n'est pas arrivé : on avance en ligne droite
-    assert(posList.size()>1);//il doit y avoir la position courante et au moins un objectif
-    Position position = posList.front();
-    Position oldPos = posList.front();
-    posList.pop_front();
-    Position& target = posList.front();
-
-    //update the position p(t) -> p(t+dt) = p(t)+dt*s(t)
-    float dX = speed.first*dt.asSeconds();
-    float dY = speed.second*dt.asSeconds();
-    position.add(dX,dY);
-    if (position.getX()>=map.getMapWidth()) {
-      position.setX(map.getMapWidth()-0.5);
-    }
-    if (position.getX()<0) {
-      position.setX(0.5);
-    }
-    if (position.getY()>=map.getMapHeight()) {
-      position.setY(map.getMapHeight()-0.5);
-    }
-    if (position.getY()<0) {
-      position.setY(0.5);
+void Trajectory::reachedWaypoint() {
+  assert(!hasArrived);
+  if (route && next+1 < (int) route->size()) {
+    next++;
+    if (DEBUG) {
+      Position w = getWaypoint();
+      printf("NPC: new target: %f %f, current position: %f %f\n",w.getX(),w.getY(),position.getX(),position.getY());
     }
+    return;
+  }
+  //c'était la cible
+  speed.first = 0;
+  speed.second = 0;
+  hasArrived = true;
+  route.reset();
+  field.reset();
+  if (DEBUG) {
+    printf("NPC: arrived !\n");
+  }
+  return;
+}
 
-    if (!position.isInTile(map).isWalkable()) {
-      position = oldPos;
-    }
 
+void Trajectory::step(NpcStore& npcs,int i,sf::Time dt,Geography& map,const SpatialIndex& neighbours,
+                      NeighbourBatch& batch) {
+  unsigned char flags = npcs.flags[i];
+  float timer = npcs.timer[i];
+  unsigned int seed = npcs.seed[i];
+  if (flags & (NpcStore::ARRIVED | NpcStore::DYING | NpcStore::DEAD)) {
+    //on est arrivé, ou on ne bouge plus
+    npcs.nextX[i] = npcs.x[i];
+    npcs.nextY[i] = npcs.y[i];
+    npcs.nextVx[i] = npcs.vx[i];
+    npcs.nextVy[i] = npcs.vy[i];
+    npcs.nextAx[i] = npcs.ax[i];
+    npcs.nextAy[i] = npcs.ay[i];
+    npcs.nextTimer[i] = timer;
+    npcs.nextFlags[i] = flags;
+    npcs.nextSeed[i] = seed;
+    return;
+  }
+  float t = dt.asSeconds();
+  float speedNorm = npcs.speedNorm[i];
+  float oldX = npcs.x[i], oldY = npcs.y[i];
+  float vx = npcs.vx[i], vy = npcs.vy[i];
+  float ax = npcs.ax[i], ay = npcs.ay[i];
+
+  //update the position p(t) -> p(t+dt) = p(t)+dt*s(t)
+  float x = oldX + vx*t;
+  float y = oldY + vy*t;
+  if (x>=map.getMapWidth()) {
+    x = map.getMapWidth()-0.5;
+  }
+  if (x<0) {
+    x = 0.5;
+  }
+  if (y>=map.getMapHeight()) {
+    y = map.getMapHeight()-0.5;
+  }
+  if (y<0) {
+    y = 0.5;
+  }
 
-    updateTimer(oldPos,position,speedNorm,dt,map);
+  if (!map.getTileRef((int) x,(int) y).isWalkable()) {
+    x = oldX;
+    y = oldY;
+  }
 
+  bool sameTile = (int) x == (int) oldX && (int) y == (int) oldY;
+  updateTimer(sameTile,speedNorm,t,timer,flags,seed);
+
+  //update the speed s(t) -> s(t+dt) = s(t)+dt*a(t)
+  vx += ax * t;
+  vy += ay * t;
+  //speed is capped by speedNorm
+  float speedNorm2 = sqrt(vx*vx+vy*vy);
+  if (speedNorm2 > speedNorm) {
+    vx = vx * (speedNorm/speedNorm2);
+    vy = vy * (speedNorm/speedNorm2);
+  }
 
-    //update the speed s(t) -> s(t+dt) = s(t)+dt*a(t)
-    speed.first += acceleration.first * dt.asSeconds();
-    speed.second += acceleration.second * dt.asSeconds();
-    //speed is capped by speedNorm
-    float speedNorm2 = sqrt(pow(speed.first,2)+pow(speed.second,2));
-    if (speedNorm2 > speedNorm) {
-      speed.first = speed.first * (speedNorm/speedNorm2);
-      speed.second = speed.second * (speedNorm/speedNorm2);
-    }
-    
-    //update the acceleration a(t) -> a(t+dt) = 1/tau * (v0(t+dt)-v(t+dt))
-    if (ignoreTarget) {//we ignore the target
-      acceleration.first = 0;
-      acceleration.second = 0;
-    } else {
-      float v0X = target.getX()-position.getX();
-      float v0Y = target.getY()-position.getY();
-      float norm = (float)sqrt(pow(v0X,2)+pow(v0Y,2));
-      if (norm>0) {
-        v0X = v0X*speedNorm/norm;
-        v0Y = v0Y*speedNorm/norm;
-      }
-      acceleration.first = (1/tau) * (v0X - speed.first);
-      acceleration.second = (1/tau) * (v0Y - speed.second);
+  //the point headed for : the waypoint, or the next tile given by the field
+  float tx = npcs.tx[i], ty = npcs.ty[i];
+  bool reached;
+  const FlowField* field = npcs.field[i];
+  if (field) {
+    int tile = field->getId((int) x,(int) y);
+    int next = field->getNext(tile);
+    if (next != -1) {
+      tx = field->getAbs(next) + 0.5;
+      ty = field->getOrd(next) + 0.5;
     }
-    
-    //add the other NPCs' potentials
-    std::list<NPC*> neighbours = position.isInTile(map).getNPCsInRadius(map,2);
-    while (!neighbours.empty()) {
-      NPC* tempNPC = neighbours.front();
-      neighbours.pop_front();
-      if (npc.getUuid()!=tempNPC->getUuid()) {
-        //only if it is not the NPC to ignore
-        std::pair<float,float> force;
-        force = tempNPC->gradPot(position);
-        acceleration.first -= force.first;
-        acceleration.second -= force.second;
-        //printf("NPC: force %f %f\n",force.first,force.second);
-      }
+    reached = field->getDistance(tile) == 0;
+  } else {
+    float dX = tx-x;
+    float dY = ty-y;
+    reached = sqrt(dX*dX+dY*dY) <= 0.1;//on est assez proche de l'objectif
+  }
+
+  //update the acceleration a(t) -> a(t+dt) = 1/tau * (v0(t+dt)-v(t+dt))
+  if (flags & NpcStore::IGNORE_TARGET) {//we ignore the target
+    ax = 0;
+    ay = 0;
+  } else {
+    float v0X = tx-x;
+    float v0Y = ty-y;
+    float norm = sqrt(v0X*v0X+v0Y*v0Y);
+    if (norm>0) {
+      v0X = v0X*speedNorm/norm;
+      v0Y = v0Y*speedNorm/norm;
     }
-    
-    float dist1 = position.distance(target);
-    
-    if (dist1 <= 0.1) {//on est assez proche de l'objectif
-      posList.pop_front();
-      if (posList.empty()) {//il ne reste plus que la position courante
-        speed.first = 0;
-        speed.second = 0;
-        hasArrived = true;
-        if (DEBUG) {
-          printf("NPC: arrived !\n");
-        }
-      } else {
-        if (DEBUG) {
-          printf("NPC: new target: %f %f, current position: %f %f\n",posList.front().getX(), posList.front().getY(),position.getX(),position.getY());
-        }
-      }
+    ax = (1/tau) * (v0X - vx);
+    ay = (1/tau) * (v0Y - vy);
+  }
+
+  //add the other NPCs' potentials, as they were at the previous tick
+  batch.clear();
+  neighbours.forEachInRadius((int) x,(int) y,2,[&](NpcHandle h) {
+    int j = npcs.getIndex(h);
+    if (j != i) {
+      //only if it is not the NPC itself
+      batch.push(npcs.x[j],npcs.y[j],npcs.vx[j],npcs.vy[j],npcs.deltaT[j],npcs.lambda[j],npcs.Vzero[j]);
     }
-    posList.push_front(position);
+  });
+  std::pair<float,float> force = SocialForce::gradPot(x,y,batch);
+  ax -= force.first;
+  ay -= force.second;
+
+  if (reached) {
+    flags |= NpcStore::WAYPOINT_REACHED;
   }
+
+  npcs.nextX[i] = x;
+  npcs.nextY[i] = y;
+  npcs.nextVx[i] = vx;
+  npcs.nextVy[i] = vy;
+  npcs.nextAx[i] = ax;
+  npcs.nextAy[i] = ay;
+  npcs.nextTimer[i] = timer;
+  npcs.nextFlags[i] = flags;
+  npcs.nextSeed[i] = seed;
   return;
 }
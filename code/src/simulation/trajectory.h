@@ -4,36 +4,51 @@
 #ifndef TRAJECTORY_H
 #define TRAJECTORY_H
 
-#include <list>
 #include "position.h"
 #include <SFML/System.hpp>
 #include "../generation/geography.h"
 #include <vector>
 #include <cmath>
-#include<boost/heap/fibonacci_heap.hpp>
-#include "tilewrapper.h"
+#include "spatialIndex.h"
+#include "npcStore.h"
+#include "socialForce.h"
+#include "routeCache.h"
+#include <memory>
 
 class Tile;
 class Coordinates;
-
-typedef typename boost::heap::fibonacci_heap<TileWrapper*,boost::heap::compare<TileWrapperComparator>> PriorityQueue;
+class NavGrid;
+class FlowField;
 
 /**
  * @brief The Trajectory class
  * contains the trajectory of a NPC
+ * The path is a route of the RouteCache, shared with the other NPCs going
+ * the same way, and a cursor on its next tile : the NPC goes to each tile in
+ * turn, always at the same place inside the tile (its offset), then to the
+ * target itself.
  */
 class Trajectory {
  private:
   bool hasArrived;
   std::pair<float,float> speed;
   std::pair<float,float> acceleration;
-  float tau = 0.2;
-  std::list<Position> posList;
-  void explore(TileWrapper* y,TileWrapper* z,PriorityQueue& open);
+  static constexpr float tau = 0.2;
+  Position position;
+  Position target;
+  /* les tiles du chemin, la première étant celle du départ ; l'étape courante est route[next] */
+  RouteCache::Route route;
+  int next;
+  int height; // de la grille de route, pour retrouver les coordonnées d'une tile
+  std::pair<float,float> offset;
   void pathfinding(Geography& map);
   sf::Time timeoutIgnoreTarget;
   bool ignoreTarget;
-  void updateTimer(Position& oldPos,Position& newPos,float speedNorm,sf::Time dt,Geography& map);
+  /* le champ suivi au lieu des étapes, voir followField */
+  std::shared_ptr<const FlowField> field;
+  static void updateTimer(bool sameTile,float speedNorm,float dt,float& timer,unsigned char& flags,unsigned int& seed);
+
+  friend class NpcStore;
 
 
  public:
@@ -59,10 +74,87 @@ class Trajectory {
   void setTarget(Position target, Geography& map);
 
   /**
-   * @brief getPosList
-   * @return the Trajectory's Position list as a reference
+   * @brief headTowards
+   * to be called when a new target has been given but its path is not known
+   * yet : the NPC keeps its current path if it has one, and otherwise goes
+   * straight to the target until followPath is called
+   * @param target: the new target position
+   */
+  void headTowards(Position target);
+
+  /**
+   * @brief findPath
+   * gives the route between two tiles, from the RouteCache of the map or
+   * computed and then cached, without touching any Trajectory : it can be
+   * called from any thread
+   * @param map: the map on which the route is searched
+   * @param start: the id of the start tile, see NavGrid
+   * @param goal: the id of the target tile
+   * @return the tiles where the route turns, see RouteCache, or null if the
+   * goal cannot be reached ; the tiles which can be skipped by going straight
+   * (see NavGrid::inSight) have been removed
+   */
+  static RouteCache::Route findPath(Geography& map, int start, int goal);
+
+  /**
+   * @brief findPath
+   * gives the route between the tiles of two positions, see above
+   */
+  static RouteCache::Route findPath(Geography& map, Position start, Position target);
+
+  /**
+   * @brief followPath
+   * replaces the waypoints by a route given by findPath, from the current
+   * position to target, the waypoints being moved by a random offset inside
+   * their tile
+   * @param path: the tiles of the route, not empty
+   * @param grid: the grid of the map
+   * @param target: the target position
    */
-  std::list<Position>& getPosList();
+  void followPath(const RouteCache::Route& path, const NavGrid& grid, Position target);
+
+  /**
+   * @brief repairPath
+   * replaces the stretch of the remaining path which crosses blocked tiles,
+   * from the last waypoint before them to the first one after, by a detour ;
+   * the rest of the path is kept
+   * @return false if the path must be searched again from scratch, ie if the
+   * detour starts or ends in a blocked tile, or there is none
+   */
+  bool repairPath(Geography& map);
+
+  /**
+   * @brief followField
+   * makes the NPC follow a flow field instead of waypoints : at each step he
+   * heads for the next tile given by the field, until he is in one of its
+   * goals ; setTarget, headTowards and followPath stop it
+   * @param field: the field, of the map the NPC is on
+   * @param goal: the position in the goal the field leads to, kept as target
+   */
+  void followField(std::shared_ptr<const FlowField> field, Position goal);
+
+  /**
+   * @brief getField
+   * @return the flow field followed, nullptr if the NPC follows waypoints
+   */
+  const FlowField* getField() const {
+    return field.get();
+  }
+
+  /**
+   * @brief getWaypoint
+   * @return the point the Trajectory is heading for : its next waypoint, or
+   * its target
+   */
+  Position getWaypoint() const;
+
+  /**
+   * @brief getWaypoints
+   * gives the points of the rest of the path
+   * @param points: filled with the current position, the waypoints left
+   * and the target, or only the current position if the Trajectory has arrived
+   */
+  void getWaypoints(std::vector<Position>& points) const;
 
   /**
    * @brief getPosition
@@ -86,14 +178,27 @@ class Trajectory {
   bool getHasArrived();
 
   /**
-   * @brief update
-   * updates the Trajectory ie tells it to continue for a short time
+   * @brief reachedWaypoint
+   * drops the current waypoint, the Trajectory has arrived if it was the last one
+   */
+  void reachedWaypoint();
+
+  /**
+   * @brief step
+   * makes the NPC at dense index i of a NpcStore continue on its Trajectory
+   * for a short time, working only on the arrays of the store
+   * It reads the current arrays and writes the next* ones only for index i,
+   * so it can be called in parallel for different NPCs. The Trajectory object
+   * itself is updated by NpcStore::save after NpcStore::swapBuffers.
+   * @param npcs : the store
+   * @param i : the dense index of the NPC
    * @param dt : the time for which the Trajectory must continue
-   * @param speedNorm: the NPC's speed's norm
    * @param map : the map on which the Trajectory is located
-   * @param npc: a NPC to ignore in the collisions
+   * @param neighbours : the NPCs of the store sorted by tile, used for the collisions
+   * @param batch : scratch space for the neighbours, reused from one call to the next
    */
-  void update(sf::Time dt,float speedNorm,Geography& map,NPC& npc);
+  static void step(NpcStore& npcs,int i,sf::Time dt,Geography& map,const SpatialIndex& neighbours,
+                   NeighbourBatch& batch);
 
   /**
    * @brief getSpeed
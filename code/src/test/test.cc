@@ -11,15 +11,24 @@ int run() {
 }
 
 int run(std::string which)
+{
+  return run(which, std::vector<std::string>());
+}
+
+int run(std::string which, const std::vector<std::string>& args)
 {
   if (which == "sfml") {
     return sfml();
   } else if (which == "net") {
-    return net_serialization() || net_dummy() || net_real() ;
+    return net_serialization() || net_wire() || net_dummy() || net_real() ;
+  } else if (which == "net_wire") {
+    return net_wire() ;
   } else if (which == "interface_init") {
     return interface_init();
   } else if (which == "pathfinding") {
     return pathfinding();
+  } else if (which == "repair_path") {
+    return repair_path();
   } else if (which == "generation") {
     return generation();
   } else if (which == "scenario") {
@@ -38,6 +47,18 @@ int run(std::string which)
     return misc();
   } else if (which == "music") {
     return music();
+  } else if (which == "bench_position") {
+    return bench_position();
+  } else if (which == "bench_social_force") {
+    return bench_social_force();
+  } else if (which == "bench_sim") {
+    return bench_sim(args);
+  } else if (which == "bench_landmarks") {
+    return bench_landmarks(args);
+  } else if (which == "bench_pathfinding") {
+    return bench_pathfinding(args);
+  } else if (which == "bench_wire") {
+    return bench_wire(args);
   } else {
     LOG(error) << "Unknown test : " << which;
   }
@@ -12,9 +12,13 @@
 #include "test_events.h"
 #include "test_misc.h"
 #include "test_music.h"
+#include "test_position.h"
+#include "test_socialForce.h"
+#include "test_sim.h"
 namespace test {
   int run ();
   int run (std::string which);
+  int run (std::string which, const std::vector<std::string>& args);
   int sfml();
 }
 #endif
@@ -4,6 +4,8 @@
 #include <boost/archive/text_oarchive.hpp>
 #include <thread>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
 
 #include "debug.h"
 #include "test_net.h"
@@ -11,6 +13,16 @@
 #include "network/netEvent.h"
 #include "network/dummyClient.h"
 #include "network/dummyServer.h"
+#include "network/npcUpdate.h"
+#include "network/gameUpdate.h"
+#include "network/snapshotAck.h"
+#include "scenario/ActionsPC.h"
+#include "scenario/ActionsTerro.h"
+#include "scenario/NewMov.h"
+#include "scenario/PreScenarioActionList.h"
+#include "scenario/ScenarioActionList.h"
+#include "scenario/StuffList.h"
+#include "interfaceinit/chat_event.h"
 
 /*
  * @author mheinric
@@ -339,5 +351,168 @@ int net_real(){
   delete ser ;
   return i ;
 }
+
+/**
+ * @brief a message built by its default constructor, even a protected one
+ * (as WireType::decode does)
+ */
+template <class MsgType>
+static MsgType* make_default(){
+  MsgType* msg = static_cast<MsgType*>(::operator new(sizeof(MsgType))) ;
+  boost::serialization::access::construct(msg) ;
+  return msg ;
+}
+
+int net_wire(){
+  LOG(info) << "" ;
+  LOG(info) << "Wire format of every message class" ;
+
+  A_Pick* pick = make_default<A_Pick>() ;
+  pick->fake = 3 ;
+  pick->zone = std::make_pair(12, 40) ;
+  A_Kick* kick = make_default<A_Kick>() ;
+  kick->weapon = 2 ;
+  for(int i = 0 ; i < 16 ; i++)
+    kick->victim.data[i] = (unsigned char) (11*i + 5) ;
+
+  //the messages are sent through their base class, as sendMessage<Action> does
+  vector<pair<string, AbstractMessage*> > messages = {
+    {"NetEvent", new NetEvent(NetEvent::PLAYER_JOIN)}, {"TestA", new TestA(7)}, {"TestB", new TestB(8)},
+    {"GameUpdate", new GameUpdate()}, {"NpcUpdate", make_default<NpcUpdate>()},
+    {"SnapshotAck", new SnapshotAck(4, 120)},
+    {"Action", make_default<Action>()}, {"AddCop", make_default<AddCop>()}, {"AddCam", make_default<AddCam>()},
+    {"NewMouseMovNetwork", make_default<NewMouseMovNetwork>()}, {"NewMovNetwork", make_default<NewMovNetwork>()},
+    {"ScenarioAction", make_default<ScenarioAction>()}, {"ChangeDirection", make_default<ChangeDirection>()},
+    {"ChangeDestination", make_default<ChangeDestination>()}, {"AddCams", make_default<AddCams>()},
+    {"AddCops", make_default<AddCops>()}, {"ChatEvent", make_default<ChatEvent>()},
+    {"A_Pick", pick}, {"A_Kick", kick}, {"A_Shoot", make_default<A_Shoot>()},
+    {"A_Reload", make_default<A_Reload>()}, {"A_Plant", make_default<A_Plant>()}, {"A_Drop", make_default<A_Drop>()},
+    {"CoA_Pick", new CoA_Pick(1, std::make_pair(5, 6), 2, NULL)}, {"CoA_Kick", make_default<CoA_Kick>()},
+    {"CoA_Shoot", make_default<CoA_Shoot>()}, {"CoA_Reload", make_default<CoA_Reload>()},
+    {"CoA_Plant", make_default<CoA_Plant>()}, {"CoA_Drop", make_default<CoA_Drop>()},
+    {"C_Stuff", new C_Stuff()}, {"C_Gun", new C_Gun(30, 8.5f, 4)}, {"C_Mitraillette", new C_Mitraillette(6)},
+    {"C_UltraM", new C_UltraM()}, {"C_Knife", new C_Knife()}, {"C_Ammunition", new C_Ammunition(12)},
+    {"C_Bomb", new C_Bomb(100)}, {"C_FakeStuff", new C_FakeStuff()}, {"C_Flower", new C_Flower()}} ;
+
+  int failures = 0 ;
+  char buffer[1024], again[1024] ;
+  for(auto& named : messages)
+    {
+      AbstractMessage& msg = *named.second ;
+      size_t size = msg.encode(buffer, sizeof(buffer)) ;
+      AbstractMessage* read = size == 0 ? NULL : AbstractMessage::decode(buffer, size) ;
+      if(read == NULL || typeid(*read) != typeid(msg)
+         || read->encode(again, sizeof(again)) != size || memcmp(buffer, again, size) != 0)
+        {
+          LOG(info) << "TEST : " << named.first << " .........FAIL" ;
+          failures++ ;
+        }
+      delete read ;
+      delete named.second ;
+    }
+  if(failures == 0)
+    LOG(info) << "TEST : ...........OK" ;
+  return failures > 0 ;
+}
+
+
+/**
+ * @brief compares the binary wire format (AbstractMessage::encode) with the
+ * boost text archives used before, on a few typical messages : bytes per
+ * message and encode/decode times. Each message must also come back
+ * unchanged from the wire format.
+ * Prints JSON on stdout.
+ * Usage : main test bench_wire [iterations=20000]
+ * @return 1 if a message did not come back unchanged
+ */
+int bench_wire(const std::vector<std::string>& args){
+  int iterations = args.size() > 0 ? atoi(args[0].c_str()) : 20000 ;
+  typedef chrono::steady_clock Clock ;
+
+  NpcUpdate created ;
+  created.isCreated = true ;
+  for(int i = 0 ; i < 16 ; i++)
+    created.id.data[i] = (unsigned char) (37*i + 11) ;
+  created.currentPosition = Position(42.37f, 17.81f) ;
+  created.target = Position(80.5f, 3.25f) ;
+  created.fear = 0.3f ;
+  created.speed = 1.4f ;
+  created.hitboxSize = 0.25f ;
+  created.deltaT = 0.5f ;
+  created.lambda = 0.4f ;
+  created.Vzero = 2.1f ;
+  created.deathTimeout = 5 ;
+  created.textPackID = 3 ;
+  NpcUpdate moved(created) ;
+  moved.isCreated = false ;
+  NetEvent event(NetEvent::SERV_LOST) ;
+  event.setData(12) ;
+  TestA small(1) ;
+
+  vector<pair<string, AbstractMessage*> > messages = {
+    {"NpcUpdate_created", &created}, {"NpcUpdate", &moved}, {"NetEvent", &event}, {"TestA", &small}} ;
+  int failures = 0 ;
+  char buffer[1024] ;
+  cout << "{\"iterations\": " << iterations << ", \"messages\": [" ;
+  for(size_t m = 0 ; m < messages.size() ; m++)
+    {
+      AbstractMessage* msg = messages[m].second ;
+
+      //as toString and fromString did before
+      Clock::time_point t0 = Clock::now() ;
+      string text ;
+      for(int k = 0 ; k < iterations ; k++)
+        {
+          stringstream ss ;
+          {
+            text_oarchive ar(ss) ;
+            ar << msg ;
+          }
+          text = ss.str() ;
+        }
+      Clock::time_point t1 = Clock::now() ;
+      for(int k = 0 ; k < iterations ; k++)
+        {
+          stringstream ss(text) ;
+          AbstractMessage* read = NULL ;
+          {
+            text_iarchive ar(ss) ;
+            ar >> read ;
+          }
+          delete read ;
+        }
+      Clock::time_point t2 = Clock::now() ;
+
+      size_t size = 0 ;
+      for(int k = 0 ; k < iterations ; k++)
+        size = msg->encode(buffer, sizeof(buffer)) ;
+      Clock::time_point t3 = Clock::now() ;
+      for(int k = 0 ; k < iterations ; k++)
+        delete AbstractMessage::decode(buffer, size) ;
+      Clock::time_point t4 = Clock::now() ;
+
+      //the decoded message must encode to the same bytes
+      AbstractMessage* read = AbstractMessage::decode(buffer, size) ;
+      char again[1024] ;
+      if(size == 0 || size > sizeof(buffer) || read == NULL || typeid(*read) != typeid(*msg)
+         || read->encode(again, sizeof(again)) != size || memcmp(buffer, again, size) != 0)
+        {
+          LOG(error) << "bench_wire : " << messages[m].first << " did not come back unchanged" ;
+          failures++ ;
+        }
+      delete read ;
+
+      auto us = [iterations](Clock::time_point a, Clock::time_point b) {
+        return chrono::duration<float, micro>(b - a).count() / iterations ;
+      } ;
+      cout << (m > 0 ? ", " : "") << "{\"message\": \"" << messages[m].first << "\""
+           << ", \"text\": {\"bytes\": " << text.size()
+           << ", \"encode_us\": " << us(t0, t1) << ", \"decode_us\": " << us(t1, t2) << "}"
+           << ", \"binary\": {\"bytes\": " << size
+           << ", \"encode_us\": " << us(t2, t3) << ", \"decode_us\": " << us(t3, t4) << "}}" ;
+    }
+  cout << "], \"failures\": " << failures << "}" << endl ;
+  return failures > 0 ;
+}
 }
 
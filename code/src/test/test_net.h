@@ -2,6 +2,8 @@
 #define TEST_NET
 
 #include <abstractMessage.h>
+#include <string>
+#include <vector>
 #include <boost/serialization/access.hpp>
 #include <boost/serialization/export.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -18,6 +20,14 @@ namespace test {
 
   int net_serialization() ;
 
+  /**
+   * @brief net_wire : every message class comes back unchanged from the wire
+   * format when sent through AbstractMessage, see WIRE_TYPE
+   */
+  int net_wire() ;
+
+  int bench_wire(const std::vector<std::string>& args) ;
+
   class TestC {
   public :
     int data = 0 ;
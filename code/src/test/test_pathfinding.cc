@@ -5,6 +5,17 @@
 #include "HScenario.h"
 #include "localState.h"
 #include "geography.h"
+#include "navGrid.h"
+#include "landmarks.h"
+#include "pathfinder.h"
+#include "trajectory.h"
+#include "routeCache.h"
+#include <iostream>
+#include <random>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <algorithm>
 #define DEBUG false
 #include "debug.h"
 
@@ -26,4 +37,296 @@ namespace test {
     LOG(info) << "Finished test NPCs creation and pathfinding";
     return 0;
   }
+
+  /**
+   * @brief regression test of Trajectory::repairPath : tiles next to NPCs
+   * whose target is in their own tile (a route of a single tile) are blocked,
+   * the route must be kept
+   * Usage : main test repair_path
+   * @return 1 if a route was not kept
+   */
+  int repair_path() {
+    Geography geo = Generation1("424242");
+    const NavGrid& grid = geo.getNavGrid();
+    int failures = 0, checked = 0;
+    int around[4];
+    for (int id = 0; id < grid.getSize() && checked < 100; id += 97) {
+      if (grid.getMoves(id) == 0 || grid.getNeighbours(id, around) == 0) {
+        continue;
+      }
+      Position start(grid.getAbs(id) + 0.25f, grid.getOrd(id) + 0.25f);
+      Position target(grid.getAbs(id) + 0.75f, grid.getOrd(id) + 0.75f);
+      RouteCache::Route route = Trajectory::findPath(geo, start, target);
+      if (!route || route->size() != 1) {
+        continue;
+      }
+      Trajectory trajectory(start);
+      trajectory.followPath(route, grid, target);
+      std::vector<std::pair<int,int>> blocked(1, std::make_pair(grid.getAbs(around[0]), grid.getOrd(around[0])));
+      geo.setBlocked(blocked, true);
+      if (!trajectory.repairPath(geo)) {
+        failures++;
+      }
+      geo.setBlocked(blocked, false);
+      checked++;
+    }
+    LOG(info) << "repair_path : " << checked << " routes of a single tile, " << failures << " not kept";
+    return failures > 0 || checked == 0;
+  }
+
+  /**
+   * @brief benchmark of the tile A* with and without landmarks : the same
+   * random pairs of walkable tiles are searched both ways, the lengths of the
+   * paths are checked to be equal and the expanded tiles and times are
+   * printed as JSON on stdout
+   * Usage : main test bench_landmarks [pairs=2000] [landmarks=8]
+   */
+  int bench_landmarks(const std::vector<std::string>& args) {
+    int nbPairs = args.size() > 0 ? atoi(args[0].c_str()) : 2000;
+    int nbLandmarks = args.size() > 1 ? atoi(args[1].c_str()) : 8;
+
+    Geography geo = Generation1("424242");
+    const NavGrid& grid = geo.getNavGrid();
+    sf::Clock clock;
+    Landmarks landmarks(grid, nbLandmarks);
+    sf::Time preprocessing = clock.getElapsedTime();
+
+    std::vector<int> walkable;
+    for (int id = 0; id < grid.getSize(); id++) {
+      if (grid.getMoves(id) != 0) {
+        walkable.push_back(id);
+      }
+    }
+    std::default_random_engine gen(42);
+    std::uniform_int_distribution<int> pick(0, walkable.size() - 1);
+    std::vector<std::pair<int,int> > pairs;
+    for (int k = 0; k < nbPairs; k++) {
+      pairs.push_back(std::make_pair(walkable[pick(gen)], walkable[pick(gen)]));
+    }
+
+    Pathfinder pathfinder;
+    std::vector<int> path;
+    std::vector<int> lengths;
+    long long expandedPlain = 0, expandedALT = 0;
+    clock.restart();
+    for (auto& p : pairs) {
+      pathfinder.findPath(grid, p.first, p.second, path, nullptr, Pathfinder::ASTAR);
+      lengths.push_back(path.size());
+      expandedPlain += pathfinder.getExpanded();
+    }
+    sf::Time timePlain = clock.restart();
+    int mismatches = 0;
+    for (size_t k = 0; k < pairs.size(); k++) {
+      pathfinder.findPath(grid, pairs[k].first, pairs[k].second, path, &landmarks, Pathfinder::ASTAR);
+      mismatches += ((int) path.size() != lengths[k]);
+      expandedALT += pathfinder.getExpanded();
+    }
+    sf::Time timeALT = clock.restart();
+
+    std::cout << "{\"pairs\": " << nbPairs
+              << ", \"landmarks\": " << landmarks.getCount()
+              << ", \"symmetric\": " << (grid.isSymmetric() ? "true" : "false")
+              << ", \"preprocessing_ms\": " << preprocessing.asMicroseconds() / 1000.f
+              << ", \"plain\": {\"mean_expanded\": " << (float) expandedPlain / nbPairs
+              << ", \"mean_us\": " << (float) timePlain.asMicroseconds() / nbPairs << "}"
+              << ", \"alt\": {\"mean_expanded\": " << (float) expandedALT / nbPairs
+              << ", \"mean_us\": " << (float) timeALT.asMicroseconds() / nbPairs << "}"
+              << ", \"length_mismatches\": " << mismatches << "}" << std::endl;
+    return mismatches > 0;
+  }
+
+  /**
+   * @brief checks a path : every move from a tile to the next one along its
+   * legs, which go straight along a row or a column, must be allowed by the
+   * grid (and so lead to a walkable tile)
+   * @return the number of the moves of the path, or -1 if it is not valid
+   */
+  static int checkPath(const NavGrid& grid, const std::vector<int>& path) {
+    int moves = 0;
+    for (size_t k = 1; k < path.size(); k++) {
+      int i = grid.getAbs(path[k-1]), j = grid.getOrd(path[k-1]);
+      int ti = grid.getAbs(path[k]), tj = grid.getOrd(path[k]);
+      if (i != ti && j != tj) {
+        return -1;
+      }
+      while (i != ti || j != tj) {
+        unsigned char needed = ti > i ? NavGrid::RIGHT : ti < i ? NavGrid::LEFT
+          : tj > j ? NavGrid::UP : NavGrid::DOWN;
+        if (!(grid.getMoves(grid.getId(i, j)) & needed)) {
+          return -1;
+        }
+        i += (ti > i) - (ti < i);
+        j += (tj > j) - (tj < j);
+        moves++;
+      }
+    }
+    return moves;
+  }
+
+  /**
+   * @brief checks a route of the NPCs : each of its legs goes straight from a
+   * tile to the next one, every tile of the rectangle around the leg must
+   * then be walkable (see NavGrid::inSight)
+   * @return the length of the route, from the centre of a tile to the centre
+   * of the next one, or -1 if it is not valid
+   */
+  static float checkRoute(const NavGrid& grid, const std::vector<int>& route) {
+    float length = 0;
+    for (size_t k = 1; k < route.size(); k++) {
+      if (!grid.inSight(route[k-1], route[k])) {
+        return -1;
+      }
+      float di = grid.getAbs(route[k]) - grid.getAbs(route[k-1]);
+      float dj = grid.getOrd(route[k]) - grid.getOrd(route[k-1]);
+      length += std::sqrt(di*di + dj*dj);
+    }
+    return length;
+  }
+
+  /**
+   * @brief prints the latencies, in microseconds, of a list of searches
+   */
+  static void printLatencies(std::vector<float>& us) {
+    std::sort(us.begin(), us.end());
+    float total = 0;
+    for (float t : us) {
+      total += t;
+    }
+    std::cout << "\"mean_us\": " << (us.empty() ? 0 : total / us.size())
+              << ", \"p50_us\": " << (us.empty() ? 0 : us[us.size() / 2])
+              << ", \"p99_us\": " << (us.empty() ? 0 : us[us.size() * 99 / 100]);
+    return;
+  }
+
+  /**
+   * @brief benchmark and regression test of the pathfinding : for every seed
+   * a map is generated and the same random pairs of walkable tiles are
+   * searched with the tile A* (Pathfinder), with the Jump Point Search if the
+   * map allows it, and with the planner of the NPCs (Trajectory::findPath,
+   * the cache being disabled). The latencies (mean, p50, p99), the expanded
+   * tiles and heap operations of the searches, the lengths of the paths, the
+   * waypoints of the routes and the number of invalid paths are printed as
+   * JSON on stdout
+   * Usage : main test bench_pathfinding [pairs=2000] [landmarks=8] [seed...]
+   * @return 1 if a path was not valid, a reachable goal was not reached or
+   * the JPS path is not as short as the A* one
+   */
+  int bench_pathfinding(const std::vector<std::string>& args) {
+    int nbPairs = args.size() > 0 ? atoi(args[0].c_str()) : 2000;
+    int nbLandmarks = args.size() > 1 ? atoi(args[1].c_str()) : 8;
+    std::vector<std::string> seeds(args.begin() + std::min<size_t>(args.size(), 2), args.end());
+    if (seeds.empty()) {
+      seeds = {"424242", "1", "2"};
+    }
+    typedef std::chrono::steady_clock Clock;
+    int failures = 0;
+
+    std::cout << "{\"pairs\": " << nbPairs << ", \"landmarks\": " << nbLandmarks << ", \"maps\": [";
+    for (size_t s = 0; s < seeds.size(); s++) {
+      Geography geo = Generation1(seeds[s]);
+      geo.buildLandmarks(nbLandmarks);
+      geo.getRoadGraph();
+      geo.getRouteCache().setCapacity(0);
+      const NavGrid& grid = geo.getNavGrid();
+
+      std::vector<int> walkable;
+      for (int id = 0; id < grid.getSize(); id++) {
+        if (grid.getMoves(id) != 0) {
+          walkable.push_back(id);
+        }
+      }
+      std::default_random_engine gen(42);
+      std::uniform_int_distribution<int> pick(0, walkable.size() - 1);
+
+      Pathfinder pathfinder;
+      std::vector<int> path;
+      std::vector<int> jumpPath;
+      std::vector<float> timesAStar, timesJPS, timesRoute;
+      long long expanded = 0, heapOperations = 0, lengthAStar = 0, waypoints = 0;
+      long long expandedJPS = 0, heapOperationsJPS = 0, lengthJPS = 0;
+      bool jps = grid.isSymmetric();
+      double lengthRoute = 0;
+      int unreachable = 0, invalid = 0;
+      for (int k = 0; k < nbPairs; k++) {
+        int start = walkable[pick(gen)], goal = walkable[pick(gen)];
+
+        Clock::time_point t0 = Clock::now();
+        bool found = pathfinder.findPath(grid, start, goal, path, geo.getLandmarks(), Pathfinder::ASTAR);
+        Clock::time_point t1 = Clock::now();
+        expanded += pathfinder.getExpanded();
+        heapOperations += pathfinder.getHeapOperations();
+        bool jumped = found;
+        if (jps) {
+          jumped = pathfinder.findPath(grid, start, goal, jumpPath, geo.getLandmarks(), Pathfinder::JPS);
+          expandedJPS += pathfinder.getExpanded();
+          heapOperationsJPS += pathfinder.getHeapOperations();
+        }
+        Clock::time_point t2 = Clock::now();
+        RouteCache::Route route = Trajectory::findPath(geo, start, goal);
+        Clock::time_point t3 = Clock::now();
+        timesAStar.push_back(std::chrono::duration<float, std::micro>(t1 - t0).count());
+        if (jps) {
+          timesJPS.push_back(std::chrono::duration<float, std::micro>(t2 - t1).count());
+        }
+        timesRoute.push_back(std::chrono::duration<float, std::micro>(t3 - t2).count());
+
+        if (found != (bool) route || found != jumped) {
+          invalid++;
+          continue;
+        }
+        if (!found) {
+          unreachable++;
+          continue;
+        }
+        int moves = checkPath(grid, path);
+        float routeLength = checkRoute(grid, *route);
+        if (moves < 0 || routeLength < 0 || path.front() != start || path.back() != goal
+            || route->front() != start || route->back() != goal) {
+          invalid++;
+          continue;
+        }
+        if (jps) {
+          int jumpMoves = checkPath(grid, jumpPath);
+          if (jumpMoves != moves || jumpPath.front() != start || jumpPath.back() != goal) {
+            invalid++;
+            continue;
+          }
+          lengthJPS += jumpMoves;
+        }
+        lengthAStar += moves;
+        lengthRoute += routeLength;
+        waypoints += route->size();
+      }
+      int found = nbPairs - unreachable;
+      failures += invalid;
+
+      std::cout << (s > 0 ? ", " : "") << "{\"seed\": \"" << seeds[s] << "\""
+                << ", \"walkable\": " << walkable.size()
+                << ", \"unreachable\": " << unreachable
+                << ", \"invalid\": " << invalid
+                << ", \"astar\": {";
+      printLatencies(timesAStar);
+      std::cout << ", \"mean_expanded\": " << (float) expanded / nbPairs
+                << ", \"mean_heap_operations\": " << (float) heapOperations / nbPairs
+                << ", \"mean_length\": " << (found ? (float) lengthAStar / found : 0)
+                << "}, \"jps\": ";
+      if (jps) {
+        std::cout << "{";
+        printLatencies(timesJPS);
+        std::cout << ", \"mean_expanded\": " << (float) expandedJPS / nbPairs
+                  << ", \"mean_heap_operations\": " << (float) heapOperationsJPS / nbPairs
+                  << ", \"mean_length\": " << (found ? (float) lengthJPS / found : 0)
+                  << "}";
+      } else {
+        std::cout << "null";
+      }
+      std::cout << ", \"route\": {";
+      printLatencies(timesRoute);
+      std::cout << ", \"mean_length\": " << (found ? (float) lengthRoute / found : 0)
+                << ", \"mean_waypoints\": " << (found ? (float) waypoints / found : 0)
+                << "}}";
+    }
+    std::cout << "], \"invalid\": " << failures << "}" << std::endl;
+    return failures > 0;
+  }
 }
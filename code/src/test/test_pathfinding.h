@@ -1,6 +1,11 @@
 #ifndef TEST_PATHFINDING_H
 #define TEST_PATHFINDING_H
+#include <string>
+#include <vector>
 namespace test {
   int pathfinding ();
+  int repair_path ();
+  int bench_landmarks (const std::vector<std::string>& args);
+  int bench_pathfinding (const std::vector<std::string>& args);
 }
 #endif
@@ -0,0 +1,60 @@
+#include <SFML/System.hpp>
+#include <vector>
+#include "test_position.h"
+#include "position.h"
+#include "eventSource.h"
+#define DEBUG false
+#include "debug.h"
+
+namespace test {
+
+  /**
+   * @brief what a Position used to be : a couple of floats which is also an
+   * EventSource, so each instance draws an uuid and unregisters itself from
+   * the EventManager when destroyed
+   */
+  class LegacyPosition : public EventSource {
+  public:
+    LegacyPosition(float x, float y) : x(x), y(y) {}
+    float x;
+    float y;
+  };
+
+  float xOf(const LegacyPosition& p) { return p.x; }
+  float xOf(const Position& p) { return p.getX(); }
+
+  /**
+   * @brief times n construct/copy/destroy rounds of T, in ns per round
+   */
+  template <typename T>
+  float timeRounds(int n, float& sink) {
+    sf::Clock clock;
+    for (int i = 0; i < n; i++) {
+      T a(i, 0.5f*i);
+      T b(a);
+      std::vector<T> v(4, b);
+      sink += xOf(v.back()) - xOf(v.front());
+    }
+    return clock.getElapsedTime().asMicroseconds() * 1000.f / n;
+  }
+
+  /**
+   * @brief micro-benchmark of the Position value type against the former
+   * EventSource-based Position
+   */
+  int bench_position() {
+    const int N = 200000;
+    float sink = 0;
+
+    float before = timeRounds<LegacyPosition>(N, sink);
+    float after = timeRounds<Position>(N, sink);
+
+    LOG(info) << "sizeof(Position) = " << sizeof(Position);
+    LOG(info) << "construct/copy/destroy (ns per round, 6 objects)";
+    LOG(info) << "  EventSource position : " << before;
+    LOG(info) << "  value Position       : " << after;
+    LOG(info) << "  speedup              : " << before / after << "x";
+    DBG << sink;
+    return 0;
+  }
+}
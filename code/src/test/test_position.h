@@ -0,0 +1,6 @@
+#ifndef TEST_POSITION_H
+#define TEST_POSITION_H
+namespace test {
+  int bench_position ();
+}
+#endif
@@ -0,0 +1,112 @@
+#include <SFML/System.hpp>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include "main.h"
+#include "test_sim.h"
+#include "globalState.h"
+#include "generation1.h"
+#include "dummyServer.h"
+#include "routeCache.h"
+#define DEBUG false
+#include "debug.h"
+
+namespace test {
+
+  /**
+   * @brief the time spent in one phase of GlobalState::run
+   */
+  struct PhaseTime {
+    const char* name;
+    long long total = 0; // microseconds
+    long long max = 0;
+
+    void add(sf::Time t) {
+      total += t.asMicroseconds();
+      max = std::max(max, (long long) t.asMicroseconds());
+    }
+  };
+
+  /**
+   * @brief headless benchmark of the server simulation : a GlobalState with a
+   * DummyServer and N NPCs runs M ticks, and the throughput and the time of
+   * each phase of GlobalState::run are printed as JSON on stdout
+   * Usage : main test bench_sim [N=500] [M=600] [threads=0 (one per core)]
+   */
+  int bench_sim(const std::vector<std::string>& args) {
+    int nbNPCs = args.size() > 0 ? atoi(args[0].c_str()) : 500;
+    int nbTicks = args.size() > 1 ? atoi(args[1].c_str()) : 600;
+    int threads = args.size() > 2 ? atoi(args[2].c_str()) : 0;
+    std::string seed = "424242";
+
+    Geography geo = Generation1(seed);
+    GlobalState glob = GlobalState(&geo, 1, 0);
+    DummyServer server;
+    glob.setServer(&server);
+    glob.setThreadCount(threads);
+    std::default_random_engine npcGen(42);
+    dummy::createNPCs(nbNPCs, glob, geo, npcGen);
+    //les NPCs partent avec leur chemin
+    glob.getPathService().finish();
+
+    TickScheduler& scheduler = glob.getScheduler();
+    sf::Time dt = scheduler.getTickLength();
+    PhaseTime actions, diffusion, movement, updates;
+    actions.name = "actions";
+    diffusion.name = "diffusion";
+    movement.name = "movement";
+    updates.name = "updates";
+
+    //les phases de GlobalState::run, chronométrées une par une
+    sf::Clock total;
+    sf::Clock clock;
+    for (int t = 0; t < nbTicks; t++) {
+      scheduler.startTick();
+      clock.restart();
+      glob.runActions();
+      actions.add(clock.restart());
+      glob.runDiffusion(dt);
+      diffusion.add(clock.restart());
+      glob.runMovement(dt);
+      movement.add(clock.restart());
+      glob.runUpdates(dt);
+      updates.add(clock.restart());
+    }
+    float seconds = total.getElapsedTime().asSeconds();
+
+    std::cout << "{\"npcs\": " << nbNPCs
+              << ", \"ticks\": " << nbTicks
+              << ", \"threads\": " << glob.getWorkers().getThreadCount()
+              << ", \"map\": [" << geo.getMapWidth() << ", " << geo.getMapHeight() << "]"
+              << ", \"npcs_left\": " << glob.getNPCStore().size()
+              << ", \"seconds\": " << seconds
+              << ", \"ticks_per_sec\": " << nbTicks / seconds
+              << ", \"phases\": {";
+    PhaseTime* phases[] = {&actions, &diffusion, &movement, &updates};
+    for (int p = 0; p < 4; p++) {
+      std::cout << (p > 0 ? ", " : "") << "\"" << phases[p]->name << "\": {"
+                << "\"total_ms\": " << phases[p]->total / 1000.f
+                << ", \"mean_us\": " << (float) phases[p]->total / nbTicks
+                << ", \"max_us\": " << phases[p]->max << "}";
+    }
+    std::cout << "}, \"counters\": {";
+    TickProfiler& profiler = glob.getProfiler();
+    for (int c = 0; c < TickProfiler::COUNTER_COUNT; c++) {
+      TickProfiler::Counter counter = (TickProfiler::Counter) c;
+      std::cout << (c > 0 ? ", " : "") << "\"" << TickProfiler::getCounterName(counter) << "\": "
+                << profiler.getCounter(counter);
+    }
+    RouteCache& cache = geo.getRouteCache();
+    std::cout << "}, \"route_cache\": {"
+              << "\"hits\": " << cache.getHits()
+              << ", \"misses\": " << cache.getMisses()
+              << ", \"hit_rate\": " << cache.getHitRate()
+              << ", \"size\": " << cache.getSize()
+              << ", \"capacity\": " << cache.getCapacity()
+              << "}}" << std::endl;
+    return 0;
+  }
+}
@@ -0,0 +1,8 @@
+#ifndef TEST_SIM_H
+#define TEST_SIM_H
+#include <string>
+#include <vector>
+namespace test {
+  int bench_sim (const std::vector<std::string>& args);
+}
+#endif
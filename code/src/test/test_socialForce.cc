@@ -0,0 +1,86 @@
+#include <SFML/System.hpp>
+#include <vector>
+#include <cstdlib>
+#include <cmath>
+#include "test_socialForce.h"
+#include "npc.h"
+#include "npcStore.h"
+#include "socialForce.h"
+#define DEBUG false
+#include "debug.h"
+
+namespace test {
+
+  /**
+   * @brief micro-benchmark of SocialForce::gradPot against the sum of
+   * Character::gradPot over the neighbours, in a dense crowd
+   * (every NPC of the crowd is a neighbour of every point evaluated)
+   */
+  int bench_social_force() {
+    const int ROUNDS = 2000;
+    const int sizes[] = {8, 32, 128};
+    srand(42);
+
+    LOG(info) << "social force kernel : " << SocialForce::getInstructionSet();
+    LOG(info) << "neighbours | per neighbour (ns) | batched (ns) | speedup | max error";
+    int status = 0;
+    for (int size : sizes) {
+      //the crowd, packed once in a batch as Trajectory::step does at every tick
+      std::vector<NPC*> crowd;
+      NpcStore store;
+      NeighbourBatch batch;
+      for (int k = 0; k < size; k++) {
+        Position start(5 * (rand() / (float) RAND_MAX), 5 * (rand() / (float) RAND_MAX));
+        NPC* npc = new NPC(1, 10, 10, start, nullptr);
+        std::pair<float,float>& speed = npc->getTrajectory().getSpeed();
+        speed.first = 2 * (rand() / (float) RAND_MAX) - 1;
+        speed.second = 2 * (rand() / (float) RAND_MAX) - 1;
+        crowd.push_back(npc);
+        int i = store.getIndex(store.add(npc));
+        batch.push(store.x[i], store.y[i], store.vx[i], store.vy[i],
+                   store.deltaT[i], store.lambda[i], store.Vzero[i]);
+      }
+      std::vector<Position> points;
+      for (int r = 0; r < ROUNDS; r++) {
+        points.push_back(Position(5 * (rand() / (float) RAND_MAX), 5 * (rand() / (float) RAND_MAX)));
+      }
+
+      float sink = 0;
+      float error = 0;
+      std::vector<std::pair<float,float> > expected(ROUNDS);
+      sf::Clock clock;
+      for (int r = 0; r < ROUNDS; r++) {
+        std::pair<float,float> sum(0, 0);
+        for (NPC* npc : crowd) {
+          std::pair<float,float> force = npc->gradPot(points[r]);
+          sum.first += force.first;
+          sum.second += force.second;
+        }
+        expected[r] = sum;
+      }
+      float perNeighbour = clock.getElapsedTime().asMicroseconds() * 1000.f / ROUNDS;
+
+      clock.restart();
+      for (int r = 0; r < ROUNDS; r++) {
+        std::pair<float,float> force = SocialForce::gradPot(points[r].getX(), points[r].getY(), batch);
+        sink += force.first;
+        float e = (fabs(force.first - expected[r].first) + fabs(force.second - expected[r].second))
+          / (fabs(expected[r].first) + fabs(expected[r].second) + 1);
+        error = std::max(error, e);
+      }
+      float batched = clock.getElapsedTime().asMicroseconds() * 1000.f / ROUNDS;
+
+      LOG(info) << size << " | " << perNeighbour << " | " << batched << " | "
+                << perNeighbour / batched << "x | " << error;
+      if (error > 1e-2) {
+        LOG(error) << "the batched social force differs from Character::gradPot";
+        status = 1;
+      }
+      for (NPC* npc : crowd) {
+        delete npc;
+      }
+      DBG << sink;
+    }
+    return status;
+  }
+}
@@ -0,0 +1,6 @@
+#ifndef TEST_SOCIAL_FORCE_H
+#define TEST_SOCIAL_FORCE_H
+namespace test {
+  int bench_social_force ();
+}
+#endif